@@ -26,6 +26,7 @@ namespace dsm {
 #include "headers/SparseMatrix.hpp"
 #include "headers/Street.hpp"
 #include "headers/FirstOrderDynamics.hpp"
+#include "headers/ThreadPool.hpp"
 #include "utility/TypeTraits/is_node.hpp"
 #include "utility/TypeTraits/is_street.hpp"
 #include "utility/TypeTraits/is_numeric.hpp"
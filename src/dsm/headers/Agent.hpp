@@ -32,6 +32,8 @@ namespace dsm {
     Id m_id;
     std::vector<Id> m_trip;
     std::optional<Id> m_streetId;
+    std::optional<Id> m_nextStreetId;
+    std::optional<Size> m_denseItineraryIndex;
     std::optional<Id> m_srcNodeId;
     delay_t m_delay;
     double m_speed;
@@ -55,6 +57,14 @@ namespace dsm {
     /// @brief Set the street occupied by the agent
     /// @param streetId The id of the street currently occupied by the agent
     void setStreetId(Id streetId) { m_streetId = streetId; }
+    /// @brief Set the street the agent is heading to
+    /// @param nextStreetId The id of the next street, or std::nullopt if the agent has none
+    void setNextStreetId(std::optional<Id> nextStreetId) {
+      m_nextStreetId = nextStreetId;
+    }
+    /// @brief Set the dense index of the agent's current itinerary
+    /// @param index The position of the itinerary in the dynamics' dense itinerary storage
+    void setDenseItineraryIndex(Size index) { m_denseItineraryIndex = index; }
     /// @brief Set the agent's speed
     /// @param speed, The agent's speed
     /// @throw std::invalid_argument, if speed is negative
@@ -69,6 +79,10 @@ namespace dsm {
     /// @brief Decrement the agent's delay by 1
     /// @throw std::underflow_error, if delay has reached its minimum value
     void decrementDelay();
+    /// @brief Decrement the agent's delay by a given value
+    /// @param delay The value to decrement the agent's delay by
+    /// @throw std::underflow_error, if delay is greater than the agent's delay
+    void decrementDelay(delay_t const delay);
     /// @brief Increment the agent's distance by its speed * 1 second
     void incrementDistance() { m_distance += m_speed; }
     /// @brief Increment the agent's distance by a given value
@@ -86,16 +100,18 @@ namespace dsm {
     void resetTime() { m_time = 0; }
     /// @brief Update the agent's itinerary
     /// @details If possible, the agent's itinerary is updated by removing the first element
-    /// from the itinerary's vector.
+    /// from the itinerary's vector. The dense itinerary index is then cleared.
     void updateItinerary();
     /// @brief Reset the agent
     /// @details Reset the following values:
     /// - street id = std::nullopt
+    /// - next street id = std::nullopt
     /// - delay = 0
     /// - speed = 0
     /// - distance = 0
     /// - time = 0
     /// - itinerary index = 0
+    /// - dense itinerary index = std::nullopt
     void reset();
 
     /// @brief Get the agent's id
@@ -110,6 +126,12 @@ namespace dsm {
     /// @brief Get the id of the street currently occupied by the agent
     /// @return The id of the street currently occupied by the agent
     std::optional<Id> streetId() const { return m_streetId; }
+    /// @brief Get the id of the street the agent is heading to
+    /// @return The id of the next street, or std::nullopt if the agent has none
+    std::optional<Id> nextStreetId() const { return m_nextStreetId; }
+    /// @brief Get the dense index of the agent's current itinerary
+    /// @return The dense index, or std::nullopt if it has not been set for the current itinerary
+    std::optional<Size> denseItineraryIndex() const { return m_denseItineraryIndex; }
     /// @brief Get the id of the source node of the agent
     /// @return The id of the source node of the agent
     std::optional<Id> srcNodeId() const { return m_srcNodeId; }
@@ -168,17 +190,20 @@ namespace dsm {
   void Agent<delay_t>::updateItinerary() {
     if (m_itineraryIdx < m_trip.size() - 1) {
       ++m_itineraryIdx;
+      m_denseItineraryIndex = std::nullopt;
     }
   }
   template <typename delay_t>
     requires(is_numeric_v<delay_t>)
   void Agent<delay_t>::reset() {
     m_streetId = std::nullopt;
+    m_nextStreetId = std::nullopt;
     m_delay = 0;
     m_speed = 0.;
     m_distance = 0.;
     m_time = 0;
     m_itineraryIdx = 0;
+    m_denseItineraryIndex = std::nullopt;
   }
   template <typename delay_t>
     requires(is_numeric_v<delay_t>)
@@ -204,6 +229,14 @@ namespace dsm {
     }
     --m_delay;
   }
+  template <typename delay_t>
+    requires(is_numeric_v<delay_t>)
+  void Agent<delay_t>::decrementDelay(delay_t const delay) {
+    if (delay > m_delay) {
+      throw std::underflow_error(buildLog("delay_t has reached its minimum value"));
+    }
+    m_delay -= delay;
+  }
 
   template <typename delay_t>
     requires(is_numeric_v<delay_t>)
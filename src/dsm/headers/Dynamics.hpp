@@ -19,13 +19,18 @@
 #include <cmath>
 #include <cassert>
 #include <format>
-#include <thread>
 #include <exception>
+#include <fstream>
+#include <string>
 
 #include "DijkstraWeights.hpp"
 #include "Itinerary.hpp"
 #include "Graph.hpp"
 #include "SparseMatrix.hpp"
+#include "ThreadPool.hpp"
+#include "../utility/AgentStore.hpp"
+#include "../utility/Philox.hpp"
+#include "../utility/Ziggurat.hpp"
 #include "../utility/TypeTraits/is_agent.hpp"
 #include "../utility/TypeTraits/is_itinerary.hpp"
 #include "../utility/Logger.hpp"
@@ -65,57 +70,156 @@ namespace dsm {
   template <typename agent_t>
   class Dynamics {
   protected:
+    /// @brief The purpose of a random draw made for an agent during a time step
+    enum class Draw : uint32_t { NEXT_STREET, LANE, PASSAGE, SPEED, SOURCE_NODE };
+
     std::unordered_map<Id, std::unique_ptr<Itinerary>> m_itineraries;
-    std::map<Id, std::unique_ptr<agent_t>> m_agents;
+    // in insertion order, indexed by the dense index stored in m_itineraryIndices
+    std::vector<Itinerary*> m_denseItineraries;
+    std::unordered_map<Id, Size> m_itineraryIndices;
+    AgentStore<agent_t> m_agents;
     Graph m_graph;
     Time m_time, m_previousSpireTime;
     std::mt19937_64 m_generator;
+    Philox m_philox;
+    std::shared_ptr<ThreadPool> m_threadPool;
+    std::optional<std::string> m_pathCacheFile;
+
+    /// @brief Get the key of the path cache
+    /// @return uint64_t A hash of the graph and of the itineraries' ids and destinations
+    uint64_t m_pathCacheKey() const;
+    /// @brief Load the itineraries' paths from the cache file
+    /// @return bool True if the paths have been loaded, false if the file does not exist, is
+    /// corrupted or was written for a different graph or set of itineraries
+    bool m_loadPathCache();
+    /// @brief Save the itineraries' paths to the cache file
+    /// @throw std::invalid_argument if the file cannot be opened
+    void m_savePathCache() const;
+
+    /// @brief Get the current itinerary of an agent
+    /// @param pAgent A pointer to the agent, which must not be a random agent
+    /// @return Itinerary const*, A pointer to the itinerary
+    /// @details The itinerary's dense index is cached in the agent, so the id map is only
+    /// looked up the first time the agent follows each itinerary of its trip.
+    Itinerary const* m_agentItinerary(agent_t* pAgent) const {
+      auto index{pAgent->denseItineraryIndex()};
+      if (!index.has_value()) {
+        index = m_itineraryIndices.at(pAgent->itineraryId());
+        pAgent->setDenseItineraryIndex(index.value());
+      }
+      return m_denseItineraries[index.value()];
+    }
 
-    virtual void m_evolveStreet(const std::unique_ptr<Street>& pStreet,
+    virtual void m_evolveStreet(Street* pStreet,
                                 bool reinsert_agents) = 0;
-    virtual bool m_evolveNode(const std::unique_ptr<Node>& pNode) = 0;
+    virtual bool m_evolveNode(Node* pNode) = 0;
     virtual void m_evolveAgents() = 0;
+    /// @brief Notify that an agent has been added to the simulation
+    /// @param agentId The id of the agent
+    virtual void m_agentAdded([[maybe_unused]] Id agentId) {}
+    /// @brief Notify that an agent is about to be removed from the simulation
+    /// @param agentId The id of the agent, which is still in the store
+    virtual void m_agentRemoved([[maybe_unused]] Id agentId) {}
+
+    /// @brief Get the random bits of a draw made for an agent during the current step
+    /// @param agentId The id of the agent
+    /// @param draw The purpose of the draw
+    /// @param attempt The attempt number, for the draws which may need more bits
+    /// @return Philox::counter_t 128 random bits
+    /// @details The bits only depend on the seed, the agent, the time and the purpose of
+    /// the draw, so they do not depend on the order the agents are processed in, nor on
+    /// the thread processing them. A single call gives the bits of up to two uniform
+    /// numbers, see m_uniformPair.
+    Philox::counter_t m_randomBits(Id agentId, Draw draw, uint32_t attempt = 0) const {
+      return m_philox({agentId,
+                       static_cast<uint32_t>(draw) | (attempt << 8),
+                       static_cast<uint32_t>(m_time),
+                       static_cast<uint32_t>(m_time >> 32)});
+    }
+    /// @brief Draw a number uniformly distributed in [0, 1) for an agent
+    /// @param agentId The id of the agent
+    /// @param draw The purpose of the draw
+    /// @param attempt The attempt number, for the draws which may be repeated in a step
+    /// @return double The number
+    double m_uniform(Id agentId, Draw draw, uint32_t attempt = 0) const {
+      auto const bits{m_randomBits(agentId, draw, attempt)};
+      return Philox::toUniform(bits[0], bits[1]);
+    }
+    /// @brief Draw two independent numbers uniformly distributed in [0, 1) for an agent
+    /// @param agentId The id of the agent
+    /// @param draw The purpose of the draws
+    /// @return std::pair<double, double> The numbers, from a single call to the generator
+    std::pair<double, double> m_uniformPair(Id agentId, Draw draw) const {
+      auto const bits{m_randomBits(agentId, draw)};
+      return {Philox::toUniform(bits[0], bits[1]), Philox::toUniform(bits[2], bits[3])};
+    }
+    /// @brief Map a number uniformly distributed in [0, 1) to an integer in [0, n)
+    /// @param uniform The number
+    /// @param n The number of possible values, which must be positive
+    /// @return Size The integer
+    static Size m_toIndex(double uniform, Size n) {
+      return std::min(static_cast<Size>(uniform * n), n - 1);
+    }
+    /// @brief Draw an integer uniformly distributed in [0, n) for an agent
+    /// @param agentId The id of the agent
+    /// @param draw The purpose of the draw
+    /// @param n The number of possible values, which must be positive
+    /// @return Size The integer
+    Size m_uniformIndex(Id agentId, Draw draw, Size n) const {
+      // the high 32 bits of a 32 x 32 bit product, without conversions to double
+      auto const bits{m_randomBits(agentId, draw)};
+      return static_cast<Size>((static_cast<uint64_t>(bits[0]) * n) >> 32);
+    }
+    /// @brief Draw a number normally distributed for an agent
+    /// @param agentId The id of the agent
+    /// @param draw The purpose of the draw
+    /// @param mean The mean of the distribution
+    /// @param stddev The standard deviation of the distribution
+    /// @return double The number
+    double m_normal(Id agentId, Draw draw, double mean, double stddev) const {
+      auto const normal{Ziggurat::normal(
+          [&](uint32_t attempt) { return m_randomBits(agentId, draw, attempt); })};
+      return mean + stddev * normal;
+    }
 
     /// @brief Update the path of a single itinerary using Dijsktra's algorithm
     /// @param pItinerary An std::unique_prt to the itinerary
+    /// @details A single backward Dijkstra from the destination gives the distance of every
+    /// node from it. A street is then part of the path if it lies on a shortest path, i.e. if
+    /// the distance of its source equals its length plus the distance of its target.
+    /// Besides the path, the itinerary's routing table is filled, marking these streets by
+    /// their dense index. Each thread keeps its own search workspace, which shortestDistances
+    /// resets, so consecutive itineraries reuse its buffers instead of reallocating them.
     void m_updatePath(const std::unique_ptr<Itinerary>& pItinerary) {
       Size const dimension = m_graph.adjMatrix().getRowDim();
       auto const destinationID = pItinerary->destination();
       SparseMatrix<bool> path{dimension, dimension};
+      std::vector<bool> nextHops(m_graph.streets().size(), false);
+      thread_local DijkstraWorkspace workspace;
+      auto const& distances{m_graph.shortestDistances(destinationID, workspace)};
+      auto const unreachable{std::numeric_limits<double>::max()};
       // cycle over the nodes
-      for (const auto& [nodeId, node] : m_graph.nodeSet()) {
-        if (nodeId == destinationID) {
-          continue;
-        }
-        auto result{m_graph.shortestPath(nodeId, destinationID)};
-        if (!result.has_value()) {
+      for (Id nodeId{0}; nodeId < distances.size(); ++nodeId) {
+        if (nodeId == destinationID || distances[nodeId] == unreachable) {
           continue;
         }
-        // save the minimum distance between i and the destination
-        const auto minDistance{result.value().distance()};
-        for (const auto [nextNodeId, _] : m_graph.adjMatrix().getRow(nodeId)) {
-          if (nextNodeId == destinationID &&
-              minDistance ==
-                  m_graph.streetSet()[nodeId * dimension + nextNodeId]->length()) {
-            path.insert(nodeId, nextNodeId, true);
-            continue;
-          }
-          result = m_graph.shortestPath(nextNodeId, destinationID);
-
-          if (result.has_value()) {
-            // if the shortest path exists, save the distance
-            if (minDistance ==
-                result.value().distance() +
-                    m_graph.streetSet()[nodeId * dimension + nextNodeId]->length()) {
-              path.insert(nodeId, nextNodeId, true);
-            }
-          } else if ((nextNodeId != destinationID)) {
+        auto const outNeighbours{m_graph.outNeighbours(nodeId)};
+        auto const offset{m_graph.outStreetsOffset(nodeId)};
+        for (size_t i{0}; i < outNeighbours.size(); ++i) {
+          auto const nextNodeId{outNeighbours[i]};
+          if (distances[nextNodeId] == unreachable) {
             std::cerr << std::format(
                              "\033[38;2;130;30;180mWARNING: No path found from node {} "
                              "to node {}\033[0m",
                              nextNodeId,
                              destinationID)
                       << std::endl;
+            continue;
+          }
+          if (distances[nodeId] ==
+              distances[nextNodeId] + streetLength(&m_graph, nodeId, nextNodeId)) {
+            path.insert(nodeId, nextNodeId, true);
+            nextHops[offset + i] = true;
           }
         }
       }
@@ -126,7 +230,8 @@ namespace dsm {
                                  pItinerary->id(),
                                  pItinerary->destination())));
       }
-      pItinerary->setPath(path);
+      pItinerary->setPath(std::move(path));
+      pItinerary->setNextHops(std::move(nextHops));
     }
 
   public:
@@ -138,7 +243,14 @@ namespace dsm {
     virtual void evolve(bool reinsert_agents = false) = 0;
 
     /// @brief Update the paths of the itineraries based on the actual travel times
+    /// @details If a path cache file has been set, the paths are loaded from it when it matches
+    /// the current graph and itineraries. Otherwise, they are computed and saved to it.
     virtual void updatePaths();
+    /// @brief Set the file used to cache the itineraries' paths between runs
+    /// @param fileName The path of the binary cache file
+    /// @details The cache is keyed by a hash of the graph's topology, the streets' lengths and
+    /// the itineraries' ids and destinations, so a stale file is simply overwritten.
+    void setPathCacheFile(std::string const& fileName) { m_pathCacheFile = fileName; }
 
     /// @brief Set the dynamics destination nodes auto-generating itineraries
     /// @param destinationNodes The destination nodes
@@ -207,18 +319,25 @@ namespace dsm {
 
     /// @brief Reset the simulation time
     void resetTime();
+    /// @brief Set the thread pool used by the parallel phases of the simulation
+    /// @param pThreadPool A std::shared_ptr to the thread pool
+    /// @throw std::invalid_argument if the pointer is null
+    void setThreadPool(std::shared_ptr<ThreadPool> pThreadPool);
 
     /// @brief Get the graph
     /// @return const Graph&, The graph
     const Graph& graph() const { return m_graph; };
+    /// @brief Get the thread pool
+    /// @return const std::shared_ptr<ThreadPool>&, The thread pool
+    const std::shared_ptr<ThreadPool>& threadPool() const { return m_threadPool; }
     /// @brief Get the itineraries
     /// @return const std::unordered_map<Id, Itinerary>&, The itineraries
     const std::unordered_map<Id, std::unique_ptr<Itinerary>>& itineraries() const {
       return m_itineraries;
     }
     /// @brief Get the agents
-    /// @return const std::unordered_map<Id, Agent<Id>>&, The agents
-    const std::map<Id, std::unique_ptr<agent_t>>& agents() const { return m_agents; }
+    /// @return const AgentStore<agent_t>&, The agents
+    const AgentStore<agent_t>& agents() const { return m_agents; }
     /// @brief Get the number of agents currently in the simulation
     /// @return Size The number of agents
     const Size nAgents() const { return m_agents.size(); }
@@ -267,33 +386,115 @@ namespace dsm {
       : m_graph{std::move(graph)},
         m_time{0},
         m_previousSpireTime{0},
-        m_generator{std::random_device{}()} {
+        m_generator{std::random_device{}()},
+        m_threadPool{ThreadPool::defaultPool()} {
     if (seed.has_value()) {
       m_generator.seed(seed.value());
+      m_philox.seed(seed.value());
+    } else {
+      m_philox.seed(m_generator());
     }
   }
 
   template <typename agent_t>
-  void Dynamics<agent_t>::updatePaths() {
-    std::vector<std::thread> threads;
-    threads.reserve(m_itineraries.size());
-    std::exception_ptr pThreadException;
+  uint64_t Dynamics<agent_t>::m_pathCacheKey() const {
+    std::vector<std::pair<Id, Id>> itineraries;
+    itineraries.reserve(m_itineraries.size());
+    for (const auto& [itineraryId, itinerary] : m_itineraries) {
+      itineraries.emplace_back(itineraryId, itinerary->destination());
+    }
+    std::ranges::sort(itineraries);
+    auto key{m_graph.hash()};
+    for (const auto& [itineraryId, destinationId] : itineraries) {
+      key ^= (static_cast<uint64_t>(itineraryId) << 32) | destinationId;
+      key *= 1099511628211ull;
+    }
+    return key;
+  }
+
+  template <typename agent_t>
+  bool Dynamics<agent_t>::m_loadPathCache() {
+    std::ifstream file{m_pathCacheFile.value(), std::ios::binary};
+    if (!file.is_open()) {
+      return false;
+    }
+    uint64_t key, nStreets, nItineraries;
+    file.read(reinterpret_cast<char*>(&key), sizeof(key));
+    file.read(reinterpret_cast<char*>(&nStreets), sizeof(nStreets));
+    file.read(reinterpret_cast<char*>(&nItineraries), sizeof(nItineraries));
+    auto const& streets{m_graph.streets()};
+    if (!file || key != m_pathCacheKey() || nStreets != streets.size() ||
+        nItineraries != m_itineraries.size()) {
+      return false;
+    }
+    Size const dimension = m_graph.adjMatrix().getRowDim();
+    std::vector<uint64_t> words((nStreets + 63) / 64);
+    for (uint64_t i{0}; i < nItineraries; ++i) {
+      Id itineraryId;
+      file.read(reinterpret_cast<char*>(&itineraryId), sizeof(itineraryId));
+      file.read(reinterpret_cast<char*>(words.data()), words.size() * sizeof(uint64_t));
+      if (!file || !m_itineraries.contains(itineraryId)) {
+        return false;
+      }
+      SparseMatrix<bool> path{dimension, dimension};
+      std::vector<bool> nextHops(nStreets, false);
+      for (uint64_t index{0}; index < nStreets; ++index) {
+        if ((words[index / 64] >> (index % 64)) & 1) {
+          nextHops[index] = true;
+          auto const& [srcId, dstId] = streets[index]->nodePair();
+          path.insert(srcId, dstId, true);
+        }
+      }
+      auto& pItinerary{m_itineraries[itineraryId]};
+      pItinerary->setPath(std::move(path));
+      pItinerary->setNextHops(std::move(nextHops));
+    }
+    return true;
+  }
+
+  template <typename agent_t>
+  void Dynamics<agent_t>::m_savePathCache() const {
+    std::ofstream file{m_pathCacheFile.value(), std::ios::binary};
+    if (!file.is_open()) {
+      throw std::invalid_argument(buildLog("Cannot open file: " + m_pathCacheFile.value()));
+    }
+    uint64_t const key{m_pathCacheKey()};
+    uint64_t const nStreets{m_graph.streets().size()};
+    uint64_t const nItineraries{m_itineraries.size()};
+    file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+    file.write(reinterpret_cast<const char*>(&nStreets), sizeof(nStreets));
+    file.write(reinterpret_cast<const char*>(&nItineraries), sizeof(nItineraries));
+    std::vector<uint64_t> words((nStreets + 63) / 64);
     for (const auto& [itineraryId, itinerary] : m_itineraries) {
-      threads.emplace_back(std::thread([this, &itinerary, &pThreadException] {
-        try {
-          this->m_updatePath(itinerary);
-        } catch (...) {
-          if (!pThreadException)
-            pThreadException = std::current_exception();
+      std::fill(words.begin(), words.end(), 0);
+      auto const& nextHops{itinerary->nextHops()};
+      for (uint64_t index{0}; index < nextHops.size(); ++index) {
+        if (nextHops[index]) {
+          words[index / 64] |= uint64_t{1} << (index % 64);
         }
-      }));
+      }
+      file.write(reinterpret_cast<const char*>(&itineraryId), sizeof(itineraryId));
+      file.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint64_t));
     }
-    for (auto& thread : threads) {
-      thread.join();
+  }
+
+  template <typename agent_t>
+  void Dynamics<agent_t>::updatePaths() {
+    if (m_pathCacheFile.has_value() && this->m_loadPathCache()) {
+      return;
+    }
+    std::vector<const std::unique_ptr<Itinerary>*> itineraries;
+    itineraries.reserve(m_itineraries.size());
+    for (const auto& [itineraryId, itinerary] : m_itineraries) {
+      itineraries.push_back(&itinerary);
+    }
+    // Throws the first exception raised by an itinerary
+    m_threadPool->parallelFor(itineraries.size(), [this, &itineraries](std::size_t i) {
+      this->m_updatePath(*itineraries[i]);
+    });
+    if (m_pathCacheFile.has_value()) {
+      this->m_savePathCache();
     }
-    // Throw the exception launched first
-    if (pThreadException)
-      std::rethrow_exception(pThreadException);
   }
 
   template <typename agent_t>
@@ -322,7 +523,9 @@ namespace dsm {
       throw std::invalid_argument(
           buildLog(std::format("Agent with id {} already exists.", agent->id())));
     }
-    m_agents.emplace(agent->id(), std::move(agent));
+    auto const agentId{agent->id()};
+    m_agents.insert(std::move(*agent));
+    this->m_agentAdded(agentId);
   }
 
   template <typename agent_t>
@@ -336,10 +539,7 @@ namespace dsm {
   template <typename... TArgs>
     requires(std::is_constructible_v<agent_t, Id, TArgs...>)
   void Dynamics<agent_t>::addAgents(Size nAgents, TArgs&&... args) {
-    Id agentId{0};
-    if (!m_agents.empty()) {
-      agentId = m_agents.rbegin()->first + 1;
-    }
+    Id agentId{m_agents.nextId()};
     for (size_t i{0}; i < nAgents; ++i, ++agentId) {
       addAgent(std::make_unique<agent_t>(agentId, std::forward<TArgs>(args)...));
     }
@@ -367,7 +567,10 @@ namespace dsm {
 
   template <typename agent_t>
   void Dynamics<agent_t>::removeAgent(Size agentId) {
-    m_agents.erase(agentId);
+    if (m_agents.contains(agentId)) {
+      this->m_agentRemoved(agentId);
+      m_agents.erase(agentId);
+    }
   }
 
   template <typename agent_t>
@@ -380,12 +583,18 @@ namespace dsm {
 
   template <typename agent_t>
   void Dynamics<agent_t>::addItinerary(const Itinerary& itinerary) {
-    m_itineraries.emplace(itinerary.id(), std::make_unique<Itinerary>(itinerary));
+    this->addItinerary(std::make_unique<Itinerary>(itinerary));
   }
 
   template <typename agent_t>
   void Dynamics<agent_t>::addItinerary(std::unique_ptr<Itinerary> itinerary) {
-    m_itineraries.emplace(itinerary->id(), std::move(itinerary));
+    auto const itineraryId{itinerary->id()};
+    auto const [it, bInserted] = m_itineraries.emplace(itineraryId, std::move(itinerary));
+    if (!bInserted) {
+      return;
+    }
+    m_itineraryIndices.emplace(itineraryId, static_cast<Size>(m_denseItineraries.size()));
+    m_denseItineraries.push_back(it->second.get());
   }
 
   template <typename agent_t>
@@ -397,7 +606,7 @@ namespace dsm {
   template <typename agent_t>
   void Dynamics<agent_t>::addItineraries(std::span<Itinerary> itineraries) {
     std::ranges::for_each(itineraries, [this](const auto& itinerary) -> void {
-      m_itineraries.insert(std::make_unique<Itinerary>(itinerary));
+      this->addItinerary(itinerary);
     });
   }
 
@@ -406,6 +615,14 @@ namespace dsm {
     m_time = 0;
   }
 
+  template <typename agent_t>
+  void Dynamics<agent_t>::setThreadPool(std::shared_ptr<ThreadPool> pThreadPool) {
+    if (!pThreadPool) {
+      throw std::invalid_argument(buildLog("The thread pool must not be null."));
+    }
+    m_threadPool = std::move(pThreadPool);
+  }
+
   template <typename agent_t>
   Measurement<double> Dynamics<agent_t>::agentMeanSpeed() const {
     std::vector<double> speeds;
@@ -420,16 +637,7 @@ namespace dsm {
 
   template <typename agent_t>
   double Dynamics<agent_t>::streetMeanSpeed(Id streetId) const {
-    auto const& pStreet{m_graph.streetSet().at(streetId)};
-    auto const nAgents{pStreet->nAgents()};
-    if (nAgents == 0) {
-      return 0.;
-    }
-    double speed{0.};
-    for (auto const& agentId : pStreet->waitingAgents()) {
-      speed += m_agents.at(agentId)->speed();
-    }
-    return speed / nAgents;
+    return m_graph.streetSet().at(streetId)->meanSpeed();
   }
 
   template <typename agent_t>
@@ -506,7 +714,7 @@ namespace dsm {
     flows.reserve(m_graph.streetSet().size());
     for (const auto& [streetId, street] : m_graph.streetSet()) {
       if (street->isSpire()) {
-        auto& spire = dynamic_cast<SpireStreet&>(*street);
+        auto& spire = static_cast<SpireStreet&>(*street);
         flows.push_back(static_cast<double>(spire.inputCounts(resetValue)) / deltaTime);
       }
     }
@@ -524,7 +732,7 @@ namespace dsm {
     flows.reserve(m_graph.streetSet().size());
     for (auto const& [streetId, street] : m_graph.streetSet()) {
       if (street->isSpire()) {
-        auto& spire = dynamic_cast<SpireStreet&>(*street);
+        auto& spire = static_cast<SpireStreet&>(*street);
         flows.push_back(static_cast<double>(spire.outputCounts(resetValue)) / deltaTime);
       }
     }
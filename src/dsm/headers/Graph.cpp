@@ -11,17 +11,22 @@ namespace dsm {
         m_maxAgentCapacity{std::numeric_limits<unsigned long long>::max()} {
     assert(adj.getRowDim() == adj.getColDim());
     auto n{static_cast<Size>(adj.getRowDim())};
-    for (const auto& [id, value] : adj) {
-      const auto srcId{static_cast<Id>(id / n)};
-      const auto dstId{static_cast<Id>(id % n)};
+    const bool bLinearIds{adj.max_size() <= std::numeric_limits<Id>::max()};
+    for (const auto& [index, value] : adj) {
+      const auto srcId{static_cast<Id>(index / n)};
+      const auto dstId{static_cast<Id>(index % n)};
       if (!m_nodes.contains(srcId)) {
         m_nodes.emplace(srcId, std::make_unique<Intersection>(srcId));
       }
       if (!m_nodes.contains(dstId)) {
         m_nodes.emplace(dstId, std::make_unique<Intersection>(dstId));
       }
+      const auto id{bLinearIds ? static_cast<Id>(index) : static_cast<Id>(m_streets.size())};
       m_streets.emplace(id, std::make_unique<Street>(id, std::make_pair(srcId, dstId)));
     }
+    m_buildStreetIndex();
+    m_buildAdjacencyLists();
+    m_buildDenseStorage();
   }
 
   Graph::Graph(const std::unordered_map<Id, std::unique_ptr<Street>>& streetSet)
@@ -42,12 +47,30 @@ namespace dsm {
     // not sure about this, might need a bit more work
     const auto oldStreetSet{std::move(m_streets)};
     m_streets.clear();
-    const auto n{static_cast<Size>(m_nodes.size())};
+    const auto n{static_cast<uint64_t>(m_nodes.size())};
+    const bool bLinearIds{n * n <= std::numeric_limits<Id>::max()};
     std::unordered_map<Id, Id> newStreetIds;
+    if (!bLinearIds) {
+      // number the streets following the order of their node pairs
+      std::vector<std::pair<uint64_t, Id>> sortedStreets;
+      sortedStreets.reserve(oldStreetSet.size());
+      for (const auto& [streetId, street] : oldStreetSet) {
+        const auto& [srcId, dstId] = street->nodePair();
+        sortedStreets.emplace_back(srcId * n + dstId, streetId);
+      }
+      std::sort(sortedStreets.begin(), sortedStreets.end());
+      for (Id index{0}; index < sortedStreets.size(); ++index) {
+        if (index > 0 && sortedStreets[index].first == sortedStreets[index - 1].first) {
+          throw std::invalid_argument(buildLog("Street with same id already exists."));
+        }
+        newStreetIds.emplace(sortedStreets[index].second, index);
+      }
+    }
     for (const auto& [streetId, street] : oldStreetSet) {
       const auto srcId{street->nodePair().first};
       const auto dstId{street->nodePair().second};
-      const auto newStreetId{static_cast<Id>(srcId * n + dstId)};
+      const auto newStreetId{bLinearIds ? static_cast<Id>(srcId * n + dstId)
+                                        : newStreetIds.at(streetId)};
       if (m_streets.contains(newStreetId)) {
         throw std::invalid_argument(buildLog("Street with same id already exists."));
       }
@@ -59,7 +82,9 @@ namespace dsm {
         m_streets.emplace(newStreetId,
                           std::make_unique<Street>(Street{newStreetId, *street}));
       }
-      newStreetIds.emplace(streetId, newStreetId);
+      if (bLinearIds) {
+        newStreetIds.emplace(streetId, newStreetId);
+      }
     }
     for (const auto& [nodeId, node] : m_nodes) {
       // This is probably not the best way to do this
@@ -93,6 +118,79 @@ namespace dsm {
     }
   }
 
+  void Graph::m_buildStreetIndex() {
+    m_streetIndex.clear();
+    m_oppositeStreets.clear();
+    const auto n{static_cast<Size>(m_adjacency.getRowDim())};
+    m_streetIndexDim = n;
+    m_streetIndex.reserve(m_streets.size());
+    for (const auto& [streetId, street] : m_streets) {
+      const auto& [srcId, dstId] = street->nodePair();
+      m_streetIndex.emplace(static_cast<uint64_t>(srcId) * n + dstId, streetId);
+    }
+    for (const auto& [streetId, street] : m_streets) {
+      const auto& [srcId, dstId] = street->nodePair();
+      const auto it{m_streetIndex.find(static_cast<uint64_t>(dstId) * n + srcId)};
+      if (it != m_streetIndex.end()) {
+        m_oppositeStreets.emplace(streetId, it->second);
+      }
+    }
+  }
+
+  void Graph::m_buildAdjacencyLists() {
+    const auto n{static_cast<Size>(m_adjacency.getRowDim())};
+    // (node, neighbour, street) triplets, sorted by node and then by neighbour
+    std::vector<std::tuple<Id, Id, Id>> outEdges, inEdges;
+    outEdges.reserve(m_streets.size());
+    inEdges.reserve(m_streets.size());
+    for (const auto& [streetId, street] : m_streets) {
+      const auto& [srcId, dstId] = street->nodePair();
+      if (srcId >= n || dstId >= n) {
+        continue;
+      }
+      outEdges.emplace_back(srcId, dstId, streetId);
+      inEdges.emplace_back(dstId, srcId, streetId);
+    }
+    std::sort(outEdges.begin(), outEdges.end());
+    std::sort(inEdges.begin(), inEdges.end());
+    auto fill = [n](const auto& edges,
+                    std::vector<Size>& offsets,
+                    std::vector<Id>& neighbours,
+                    std::vector<Id>& streets) {
+      offsets.assign(n + 1, 0);
+      neighbours.clear();
+      streets.clear();
+      neighbours.reserve(edges.size());
+      streets.reserve(edges.size());
+      for (const auto& [nodeId, neighbourId, streetId] : edges) {
+        ++offsets[nodeId + 1];
+        neighbours.push_back(neighbourId);
+        streets.push_back(streetId);
+      }
+      std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    };
+    fill(outEdges, m_outOffsets, m_outNeighbours, m_outStreets);
+    fill(inEdges, m_inOffsets, m_inNeighbours, m_inStreets);
+  }
+
+  void Graph::m_buildDenseStorage() {
+    const auto n{static_cast<Size>(m_adjacency.getRowDim())};
+    m_denseNodes.assign(n, nullptr);
+    for (const auto& [nodeId, node] : m_nodes) {
+      if (nodeId < n) {
+        m_denseNodes[nodeId] = node.get();
+      }
+    }
+    m_denseStreets.clear();
+    m_denseStreets.reserve(m_outStreets.size());
+    m_streetIndices.clear();
+    m_streetIndices.reserve(m_outStreets.size());
+    for (const auto streetId : m_outStreets) {
+      m_streetIndices.emplace(streetId, static_cast<Size>(m_denseStreets.size()));
+      m_denseStreets.push_back(m_streets.at(streetId).get());
+    }
+  }
+
   void Graph::buildAdj() {
     // find max values in streets node pairs
     m_maxAgentCapacity = 0;
@@ -103,6 +201,9 @@ namespace dsm {
       m_adjacency.insert(street->nodePair().first, street->nodePair().second, true);
     }
     this->m_reassignIds();
+    this->m_buildStreetIndex();
+    this->m_buildAdjacencyLists();
+    this->m_buildDenseStorage();
     this->m_setStreetAngles();
   }
 
@@ -118,12 +219,12 @@ namespace dsm {
     int16_t value;
     for (Id nodeId = 0; nodeId < m_nodes.size(); ++nodeId) {
       value = 0;
-      for (const auto& [streetId, _] : m_adjacency.getCol(nodeId, true)) {
+      for (const auto streetId : inStreets(nodeId)) {
         value += m_streets[streetId]->nLanes() * m_streets[streetId]->transportCapacity();
       }
       m_nodes[nodeId]->setCapacity(value);
       value = 0;
-      for (const auto& [streetId, _] : m_adjacency.getRow(nodeId, true)) {
+      for (const auto streetId : outStreets(nodeId)) {
         value += m_streets[streetId]->nLanes() * m_streets[streetId]->transportCapacity();
       }
       m_nodes[nodeId]->setTransportCapacity(value);
@@ -158,11 +259,16 @@ namespace dsm {
       }
       Size n{rows};
       m_adjacency = SparseMatrix<bool>(n, n);
+      // if the linear index does not fit in an Id, streets are numbered in reading order
+      const bool bLinearIds{m_adjacency.max_size() <= std::numeric_limits<Id>::max()};
       // each line has 2 elements
       while (!file.eof()) {
-        Id index;
+        uint64_t index;
         double val;
         file >> index >> val;
+        if (!bLinearIds && m_adjacency.contains(index)) {
+          continue;
+        }
         m_adjacency.insert(index, val);
         const auto srcId{static_cast<Id>(index / n)};
         const auto dstId{static_cast<Id>(index % n)};
@@ -172,13 +278,14 @@ namespace dsm {
         if (!m_nodes.contains(dstId)) {
           m_nodes.emplace(dstId, std::make_unique<Intersection>(dstId));
         }
-        m_streets.emplace(index,
-                          std::make_unique<Street>(index, std::make_pair(srcId, dstId)));
-        assert(index == srcId * n + dstId);
+        const auto streetId{bLinearIds ? static_cast<Id>(index)
+                                       : static_cast<Id>(m_streets.size())};
+        m_streets.emplace(
+            streetId, std::make_unique<Street>(streetId, std::make_pair(srcId, dstId)));
         if (!isAdj) {
-          m_streets[index]->setLength(val);
+          m_streets[streetId]->setLength(val);
         }
-        m_streets[index]->setMaxSpeed(defaultSpeed);
+        m_streets[streetId]->setMaxSpeed(defaultSpeed);
       }
     } else {
       // default case: read the file as a matrix with the first two elements being the number of rows and columns and
@@ -195,12 +302,10 @@ namespace dsm {
                      " Cols: " + std::to_string(cols)));
       }
       Size n{rows};
-      if (n * n > std::numeric_limits<Id>::max()) {
-        throw std::invalid_argument(
-            buildLog("Matrix size is too large for the current type of Id."));
-      }
       m_adjacency = SparseMatrix<bool>(n, n);
-      Id index{0};
+      // if the linear index does not fit in an Id, streets are numbered in reading order
+      const bool bLinearIds{m_adjacency.max_size() <= std::numeric_limits<Id>::max()};
+      uint64_t index{0};
       while (!file.eof()) {
         double value;
         file >> value;
@@ -218,17 +323,21 @@ namespace dsm {
           if (!m_nodes.contains(dstId)) {
             m_nodes.emplace(dstId, std::make_unique<Intersection>(dstId));
           }
-          m_streets.emplace(
-              index, std::make_unique<Street>(index, std::make_pair(srcId, dstId)));
-          assert(index == srcId * n + dstId);
+          const auto streetId{bLinearIds ? static_cast<Id>(index)
+                                         : static_cast<Id>(m_streets.size())};
+          m_streets.emplace(streetId,
+                            std::make_unique<Street>(streetId, std::make_pair(srcId, dstId)));
           if (!isAdj) {
-            m_streets[index]->setLength(value);
+            m_streets[streetId]->setLength(value);
           }
-          m_streets[index]->setMaxSpeed(defaultSpeed);
+          m_streets[streetId]->setMaxSpeed(defaultSpeed);
         }
         ++index;
       }
     }
+    m_buildStreetIndex();
+    m_buildAdjacencyLists();
+    m_buildDenseStorage();
   }
 
   void Graph::importCoordinates(const std::string& fileName) {
@@ -308,7 +417,7 @@ namespace dsm {
         std::getline(iss, lon, ';');
         std::getline(iss, lat, ';');
         std::getline(iss, highway, ';');
-        auto const nodeId{static_cast<Id>(std::stoul(id))};
+        auto const nodeId{static_cast<uint64_t>(std::stoull(id))};
         if (highway.find("traffic_signals") != std::string::npos) {
           addNode<TrafficLight>(
               nodeIndex, 60, std::make_pair(std::stod(lat), std::stod(lon)));
@@ -372,13 +481,17 @@ namespace dsm {
           }
         }
 
-        Id streetId = std::stoul(sourceId) + std::stoul(targetId) * m_nodes.size();
+        // temporary id, streets are renumbered by buildAdj
+        auto streetId{static_cast<Id>(m_streets.size())};
+        while (m_streets.contains(streetId)) {
+          ++streetId;
+        }
         addEdge<Street>(streetId,
                         std::stod(length) / 5,
                         std::stod(maxspeed),
                         std::stod(length),
-                        std::make_pair(m_nodeMapping[std::stoul(sourceId)],
-                                       m_nodeMapping[std::stoul(targetId)]),
+                        std::make_pair(m_nodeMapping[std::stoull(sourceId)],
+                                       m_nodeMapping[std::stoull(targetId)]),
                         std::stoul(lanes),
                         name);
       }
@@ -387,6 +500,23 @@ namespace dsm {
     }
   }
 
+  uint64_t Graph::hash() const {
+    uint64_t hash{14695981039346656037ull};
+    auto const combine = [&hash](uint64_t value) {
+      for (int i{0}; i < 8; ++i) {
+        hash ^= (value >> (8 * i)) & 0xff;
+        hash *= 1099511628211ull;
+      }
+    };
+    combine(m_denseNodes.size());
+    for (auto const* pStreet : m_denseStreets) {
+      combine(pStreet->nodePair().first);
+      combine(pStreet->nodePair().second);
+      combine(std::bit_cast<uint64_t>(pStreet->length()));
+    }
+    return hash;
+  }
+
   void Graph::exportMatrix(std::string path, bool isAdj) {
     std::ofstream file{path};
     if (!file.is_open()) {
@@ -436,6 +566,9 @@ namespace dsm {
     }
     auto& pNode = m_nodes[nodeId];
     pNode = std::make_unique<TrafficLight>(*pNode, cycleTime, counter);
+    if (nodeId < m_denseNodes.size()) {
+      m_denseNodes[nodeId] = pNode.get();
+    }
     return dynamic_cast<TrafficLight&>(*pNode);
   }
 
@@ -445,6 +578,9 @@ namespace dsm {
     }
     auto& pNode = m_nodes[nodeId];
     pNode = std::make_unique<Roundabout>(*pNode);
+    if (nodeId < m_denseNodes.size()) {
+      m_denseNodes[nodeId] = pNode.get();
+    }
     return dynamic_cast<Roundabout&>(*pNode);
   }
 
@@ -454,6 +590,9 @@ namespace dsm {
     }
     auto& pNode = m_nodes[nodeId];
     pNode = std::make_unique<Station>(*pNode, managementTime);
+    if (nodeId < m_denseNodes.size()) {
+      m_denseNodes[nodeId] = pNode.get();
+    }
     return dynamic_cast<Station&>(*pNode);
   }
 
@@ -464,6 +603,9 @@ namespace dsm {
     }
     auto& pStreet = m_streets[streetId];
     pStreet = std::make_unique<SpireStreet>(pStreet->id(), *pStreet);
+    if (auto it{m_streetIndices.find(streetId)}; it != m_streetIndices.end()) {
+      m_denseStreets[it->second] = pStreet.get();
+    }
     return dynamic_cast<SpireStreet&>(*pStreet);
   }
 
@@ -486,6 +628,9 @@ namespace dsm {
     }
     // emplace street
     m_streets.emplace(std::make_pair(street->id(), std::move(street)));
+    // the street index is rebuilt by buildAdj
+    m_streetIndex.clear();
+    m_oppositeStreets.clear();
   }
 
   void Graph::addStreet(const Street& street) {
@@ -507,9 +652,23 @@ namespace dsm {
     }
     // emplace street
     m_streets.emplace(std::make_pair(street.id(), std::make_unique<Street>(street)));
+    // the street index is rebuilt by buildAdj
+    m_streetIndex.clear();
+    m_oppositeStreets.clear();
   }
 
   const std::unique_ptr<Street>* Graph::street(Id source, Id destination) const {
+    if (!m_streetIndex.empty()) {
+      const auto n{m_streetIndexDim};
+      if (source >= n || destination >= n) {
+        return nullptr;
+      }
+      const auto indexIt{m_streetIndex.find(static_cast<uint64_t>(source) * n + destination)};
+      if (indexIt == m_streetIndex.end()) {
+        return nullptr;
+      }
+      return &(m_streets.at(indexIt->second));
+    }
     auto streetIt = std::find_if(m_streets.begin(),
                                  m_streets.end(),
                                  [source, destination](const auto& street) -> bool {
@@ -519,15 +678,6 @@ namespace dsm {
     if (streetIt == m_streets.end()) {
       return nullptr;
     }
-    Size n = m_nodes.size();
-    auto id1 = streetIt->first;
-    auto id2 = source * n + destination;
-    assert(id1 == id2);
-    if (id1 != id2) {
-      std::cout << "node size: " << n << std::endl;
-      std::cout << "Street id: " << id1 << std::endl;
-      std::cout << "Nodes: " << id2 << std::endl;
-    }
     return &(streetIt->second);
   }
 
@@ -538,6 +688,13 @@ namespace dsm {
                                "id once called buildAdj.",
                                streetId)));
     }
+    if (!m_streetIndex.empty()) {
+      const auto oppositeIt{m_oppositeStreets.find(streetId)};
+      if (oppositeIt == m_oppositeStreets.end()) {
+        return nullptr;
+      }
+      return &(m_streets.at(oppositeIt->second));
+    }
     const auto& nodePair = m_streets.at(streetId)->nodePair();
     return this->street(nodePair.second, nodePair.first);
   }
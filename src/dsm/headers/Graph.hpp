@@ -10,14 +10,18 @@
 #pragma once
 
 #include <algorithm>
+#include <bit>
 #include <concepts>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <ranges>
 #include <unordered_map>
 #include <unordered_set>
 #include <queue>
+#include <span>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <string>
@@ -35,6 +39,7 @@
 #include "SparseMatrix.hpp"
 #include "Street.hpp"
 #include "../utility/DijkstraResult.hpp"
+#include "../utility/DijkstraWorkspace.hpp"
 #include "../utility/Logger.hpp"
 #include "../utility/Typedef.hpp"
 #include "../utility/TypeTraits/is_node.hpp"
@@ -49,17 +54,52 @@ namespace dsm {
   private:
     std::unordered_map<Id, std::unique_ptr<Node>> m_nodes;
     std::unordered_map<Id, std::unique_ptr<Street>> m_streets;
-    std::unordered_map<Id, Id> m_nodeMapping;
+    std::unordered_map<uint64_t, Id> m_nodeMapping;
+    std::unordered_map<uint64_t, Id> m_streetIndex;
+    Size m_streetIndexDim{0};
+    std::unordered_map<Id, Id> m_oppositeStreets;
     SparseMatrix<bool> m_adjacency;
+    std::vector<Size> m_outOffsets, m_inOffsets;
+    std::vector<Id> m_outNeighbours, m_inNeighbours;
+    std::vector<Id> m_outStreets, m_inStreets;
+    std::vector<Node*> m_denseNodes;
+    std::vector<Street*> m_denseStreets;
+    std::unordered_map<Id, Size> m_streetIndices;
     unsigned long long m_maxAgentCapacity;
 
     /// @brief Reassign the street ids using the max node id
     /// @details The street ids are reassigned using the max node id, i.e.
     /// newStreetId = srcId * n + dstId, where n is the max node id.
+    /// If n * n does not fit in an Id, the streets are instead numbered from 0 following
+    /// the order of their node pairs, i.e. sorted by srcId and then by dstId.
     void m_reassignIds();
     /// @brief If every node has coordinates, set the street angles
     /// @details The street angles are set using the node's coordinates.
     void m_setStreetAngles();
+    /// @brief Build the street index and the opposite street index
+    /// @details The street index maps the linear index of a node pair, i.e. srcId * n + dstId,
+    /// to the id of the street connecting the two nodes, where n is the adjacency matrix's
+    /// dimension (stored in m_streetIndexDim). The opposite street index maps a
+    /// street id to the id of the street going in the opposite direction, if it exists.
+    void m_buildStreetIndex();
+    /// @brief Build the compressed sparse row representation of the adjacency matrix
+    /// @details Both outgoing and incoming edges are stored. For each node, the neighbours
+    /// are sorted by id and the i-th street id corresponds to the i-th neighbour.
+    void m_buildAdjacencyLists();
+    /// @brief Build the dense node and street storage
+    /// @details Nodes are indexed by their id, leaving nullptr for ids without a node, while
+    /// streets are indexed by their position in the outgoing adjacency lists, so that the
+    /// streets leaving a node are contiguous.
+    void m_buildDenseStorage();
+    static std::span<const Id> m_adjacencySpan(std::vector<Size> const& offsets,
+                                               std::vector<Id> const& values,
+                                               Id nodeId) {
+      if (static_cast<size_t>(nodeId) + 1 >= offsets.size()) {
+        return {};
+      }
+      return std::span<const Id>(values).subspan(offsets[nodeId],
+                                                 offsets[nodeId + 1] - offsets[nodeId]);
+    }
 
   public:
     Graph();
@@ -79,7 +119,17 @@ namespace dsm {
             this->m_streets.emplace(pair.first, pair.second.get());
           });
       m_nodeMapping = other.m_nodeMapping;
+      m_streetIndex = other.m_streetIndex;
+      m_streetIndexDim = other.m_streetIndexDim;
+      m_oppositeStreets = other.m_oppositeStreets;
       m_adjacency = other.m_adjacency;
+      m_outOffsets = other.m_outOffsets;
+      m_inOffsets = other.m_inOffsets;
+      m_outNeighbours = other.m_outNeighbours;
+      m_inNeighbours = other.m_inNeighbours;
+      m_outStreets = other.m_outStreets;
+      m_inStreets = other.m_inStreets;
+      m_buildDenseStorage();
     }
 
     Graph& operator=(const Graph& other) {
@@ -93,7 +143,17 @@ namespace dsm {
                                              std::make_unique<Street>(*pair.second));
           });
       m_nodeMapping = other.m_nodeMapping;
+      m_streetIndex = other.m_streetIndex;
+      m_streetIndexDim = other.m_streetIndexDim;
+      m_oppositeStreets = other.m_oppositeStreets;
       m_adjacency = other.m_adjacency;
+      m_outOffsets = other.m_outOffsets;
+      m_inOffsets = other.m_inOffsets;
+      m_outNeighbours = other.m_outNeighbours;
+      m_inNeighbours = other.m_inNeighbours;
+      m_outStreets = other.m_outStreets;
+      m_inStreets = other.m_inStreets;
+      m_buildDenseStorage();
 
       return *this;
     }
@@ -104,6 +164,8 @@ namespace dsm {
     /// @brief Build the graph's adjacency matrix and computes max capacity
     /// @details The adjacency matrix is built using the graph's streets and nodes. N.B.: The street ids
     /// are reassigned using the max node id, i.e. newStreetId = srcId * n + dstId, where n is the max node id.
+    /// On networks too large for this scheme, i.e. if n * n does not fit in an Id, the streets are numbered
+    /// by their position once sorted by source and destination node.
     void buildAdj();
     /// @brief Build the graph's street angles using the node's coordinates
     void buildStreetAngles();
@@ -226,6 +288,55 @@ namespace dsm {
     /// @brief Get the graph's adjacency matrix
     /// @return A std::shared_ptr to the graph's adjacency matrix
     const SparseMatrix<bool>& adjMatrix() const { return m_adjacency; }
+    /// @brief Get the ids of the nodes reachable from a node through a single street
+    /// @param nodeId The node's id
+    /// @return A std::span of the neighbours' ids, sorted by id
+    /// @details The span is empty if the node has no outgoing streets or the adjacency
+    /// lists have not been built yet, i.e. buildAdj has not been called.
+    std::span<const Id> outNeighbours(Id nodeId) const {
+      return m_adjacencySpan(m_outOffsets, m_outNeighbours, nodeId);
+    }
+    /// @brief Get the ids of the streets leaving a node
+    /// @param nodeId The node's id
+    /// @return A std::span of the streets' ids, in the same order of outNeighbours
+    std::span<const Id> outStreets(Id nodeId) const {
+      return m_adjacencySpan(m_outOffsets, m_outStreets, nodeId);
+    }
+    /// @brief Get the ids of the nodes from which a node can be reached through a single street
+    /// @param nodeId The node's id
+    /// @return A std::span of the neighbours' ids, sorted by id
+    std::span<const Id> inNeighbours(Id nodeId) const {
+      return m_adjacencySpan(m_inOffsets, m_inNeighbours, nodeId);
+    }
+    /// @brief Get the ids of the streets entering a node
+    /// @param nodeId The node's id
+    /// @return A std::span of the streets' ids, in the same order of inNeighbours
+    std::span<const Id> inStreets(Id nodeId) const {
+      return m_adjacencySpan(m_inOffsets, m_inStreets, nodeId);
+    }
+    /// @brief Get the graph's nodes in dense storage
+    /// @return A std::span of pointers to the nodes, where the i-th element is the node with id i,
+    /// or nullptr if there is no node with id i
+    /// @details The storage is filled by buildAdj and kept up to date by the make* functions.
+    /// Its size is the adjacency matrix's dimension, so a graph built by importMatrix or from a
+    /// SparseMatrix with isolated nodes has nullptr holes: callers must skip them.
+    std::span<Node* const> nodes() const { return m_denseNodes; }
+    /// @brief Get the graph's streets in dense storage
+    /// @return A std::span of pointers to the streets, sorted by source and destination node
+    /// @details The i-th element is the street with dense index i. The streets leaving a node
+    /// are contiguous and follow the order of outStreets.
+    std::span<Street* const> streets() const { return m_denseStreets; }
+    /// @brief Get the dense index of a street
+    /// @param streetId The street's id
+    /// @return The position of the street in the dense storage
+    /// @throws std::out_of_range if the street is not in the dense storage
+    Size streetIndex(Id streetId) const { return m_streetIndices.at(streetId); }
+    /// @brief Get the dense index of the first street leaving a node
+    /// @param nodeId The node's id
+    /// @return The dense index of the first street leaving the node
+    /// @details The i-th street of outStreets(nodeId) has dense index outStreetsOffset(nodeId) + i.
+    /// The adjacency lists must have been built, i.e. buildAdj must have been called.
+    Size outStreetsOffset(Id nodeId) const { return m_outOffsets[nodeId]; }
     /// @brief Get the graph's number of nodes
     /// @return size_t The number of nodes in the graph
     size_t nNodes() const { return m_nodes.size(); }
@@ -252,16 +363,25 @@ namespace dsm {
     /// @param source The source node
     /// @param destination The destination node
     /// @return A std::unique_ptr to the street if it exists, nullptr otherwise
+    /// @details Once buildAdj has been called the lookup takes constant time, otherwise
+    /// the whole street set is scanned.
     const std::unique_ptr<Street>* street(Id source, Id destination) const;
     /// @brief Get the opposite street of a street in the graph
     /// @param streetId The id of the street
     /// @throws std::invalid_argument if the street does not exist
     /// @return A std::unique_ptr to the street if it exists, nullptr otherwise
+    /// @details Once buildAdj has been called the lookup takes constant time.
     const std::unique_ptr<Street>* oppositeStreet(Id streetId) const;
 
     /// @brief Get the maximum agent capacity
     /// @return unsigned long long The maximum agent capacity of the graph
     unsigned long long maxCapacity() const { return m_maxAgentCapacity; }
+    /// @brief Get a hash of the graph's content
+    /// @return uint64_t A FNV-1a hash of the number of nodes and of the node pair and length of
+    /// every street, in dense order
+    /// @details Two graphs with the same hash have the same shortest paths. The dense storage
+    /// must have been built, i.e. buildAdj must have been called.
+    uint64_t hash() const;
 
     /// @brief Get the shortest path between two nodes using dijkstra algorithm
     /// @param source The source node
@@ -282,6 +402,33 @@ namespace dsm {
     std::optional<DijkstraResult> shortestPath(Id source,
                                                Id destination,
                                                Func f = streetLength) const;
+
+    /// @brief Get the shortest path between two nodes using dijkstra algorithm
+    /// @param source The source node id
+    /// @param destination The destination node id
+    /// @param workspace The workspace holding the search buffers, reused across calls
+    /// @return A DijkstraResult object containing the path and the distance
+    /// @details Once the workspace buffers have grown to the graph's size, consecutive
+    /// queries sharing the same workspace do not allocate memory for the search.
+    template <typename Func = std::function<double(const Graph*, Id, Id)>>
+      requires(std::is_same_v<std::invoke_result_t<Func, const Graph*, Id, Id>, double>)
+    std::optional<DijkstraResult> shortestPath(Id source,
+                                               Id destination,
+                                               DijkstraWorkspace& workspace,
+                                               Func f = streetLength) const;
+
+    /// @brief Get the distance of every node from a destination using a backward dijkstra
+    /// @param destination The destination node id
+    /// @param workspace The workspace holding the search buffers, reused across calls
+    /// @return A vector containing the distance of each node from the destination, indexed by node id.
+    /// Nodes which can't reach the destination have distance std::numeric_limits<double>::max()
+    /// @details The search runs on the transposed graph, so a single call gives the
+    /// distance-to-destination of every node. The returned vector is owned by the workspace.
+    template <typename Func = std::function<double(const Graph*, Id, Id)>>
+      requires(std::is_same_v<std::invoke_result_t<Func, const Graph*, Id, Id>, double>)
+    const std::vector<double>& shortestDistances(Id destination,
+                                                 DijkstraWorkspace& workspace,
+                                                 Func f = streetLength) const;
   };
 
   template <typename node_t, typename... TArgs>
@@ -328,6 +475,9 @@ namespace dsm {
     }
     // emplace street
     m_streets.emplace(std::make_pair(street.id(), std::make_unique<Street>(street)));
+    // the street index is rebuilt by buildAdj
+    m_streetIndex.clear();
+    m_oppositeStreets.clear();
   }
 
   template <typename T1, typename... Tn>
@@ -343,95 +493,102 @@ namespace dsm {
   std::optional<DijkstraResult> Graph::shortestPath(const Node& source,
                                                     const Node& destination,
                                                     Func f) const {
-    return this->shortestPath(source.id(), destination.id());
+    return this->shortestPath(source.id(), destination.id(), f);
+  }
+
+  template <typename Func>
+    requires(std::is_same_v<std::invoke_result_t<Func, const Graph*, Id, Id>, double>)
+  std::optional<DijkstraResult> Graph::shortestPath(Id source,
+                                                    Id destination,
+                                                    Func getStreetWeight) const {
+    DijkstraWorkspace workspace;
+    return this->shortestPath(source, destination, workspace, getStreetWeight);
   }
 
   template <typename Func>
     requires(std::is_same_v<std::invoke_result_t<Func, const Graph*, Id, Id>, double>)
   std::optional<DijkstraResult> Graph::shortestPath(Id source,
                                                     Id destination,
+                                                    DijkstraWorkspace& workspace,
                                                     Func getStreetWeight) const {
-    const Id sourceId{source};
-
-    std::unordered_set<Id> unvisitedNodes;
-    bool source_found{false};
-    bool dest_found{false};
-    std::for_each(m_nodes.begin(),
-                  m_nodes.end(),
-                  [&unvisitedNodes, &source_found, &dest_found, source, destination](
-                      const auto& node) -> void {
-                    if (!source_found && node.first == source) {
-                      source_found = true;
-                    }
-                    if (!dest_found && node.first == destination) {
-                      dest_found = true;
-                    }
-                    unvisitedNodes.emplace(node.first);
-                  });
-    if (!source_found || !dest_found) {
+    if (!m_nodes.contains(source) || !m_nodes.contains(destination)) {
+      return std::nullopt;
+    }
+    const size_t n_nodes{m_outOffsets.empty() ? 0 : m_outOffsets.size() - 1};
+    if (source >= n_nodes || destination >= n_nodes) {
       return std::nullopt;
     }
 
-    const size_t n_nodes{m_nodes.size()};
-    auto adj{m_adjacency};
-
-    std::unordered_set<Id> visitedNodes;
-    std::vector<std::pair<Id, double>> dist(n_nodes);
-    std::for_each(dist.begin(), dist.end(), [count = 0](auto& element) mutable -> void {
-      element.first = count;
-      element.second = std::numeric_limits<double>::max();
-      ++count;
-    });
-    dist[source] = std::make_pair(source, 0.);
-
-    std::vector<std::pair<Id, double>> prev(n_nodes);
-    std::for_each(prev.begin(), prev.end(), [](auto& pair) -> void {
-      pair.first = std::numeric_limits<Id>::max();
-      pair.second = std::numeric_limits<double>::max();
-    });
-    prev[source].second = 0.;
-
-    while (unvisitedNodes.size() != 0) {
-      source = *std::min_element(unvisitedNodes.begin(),
-                                 unvisitedNodes.end(),
-                                 [&dist](const auto& a, const auto& b) -> bool {
-                                   return dist[a].second < dist[b].second;
-                                 });
-
-      unvisitedNodes.erase(source);
-      visitedNodes.emplace(source);
-
-      const auto& neighbors{adj.getRow(source)};
-      for (const auto& neighbour : neighbors) {
-        // if the node has already been visited, skip it
-        if (visitedNodes.find(neighbour.first) != visitedNodes.end()) {
-          continue;
-        }
-        double streetWeight = getStreetWeight(this, source, neighbour.first);
+    workspace.reset(n_nodes);
+    auto& dist{workspace.distances()};
+    auto& prev{workspace.previous()};
+    dist[source] = 0.;
+    workspace.push(source, 0.);
+
+    while (!workspace.empty()) {
+      const auto [distance, nodeId] = workspace.pop();
+      // stale heap entry, the node has already been settled
+      if (distance > dist[nodeId]) {
+        continue;
+      }
+      if (nodeId == destination) {
+        break;
+      }
+      for (const auto neighbourId : outNeighbours(nodeId)) {
+        const double newDistance{distance + getStreetWeight(this, nodeId, neighbourId)};
         // if current path is shorter than the previous one, update the distance
-        if (streetWeight + dist[source].second < dist[neighbour.first].second) {
-          dist[neighbour.first].second = streetWeight + dist[source].second;
-          prev[neighbour.first] = std::make_pair(source, dist[neighbour.first].second);
+        if (newDistance < dist[neighbourId]) {
+          dist[neighbourId] = newDistance;
+          prev[neighbourId] = nodeId;
+          workspace.push(neighbourId, newDistance);
         }
       }
-
-      adj.emptyColumn(source);
     }
 
+    if (prev[destination] == std::numeric_limits<Id>::max()) {
+      return std::nullopt;
+    }
     std::vector<Id> path{destination};
     Id previous{destination};
-    while (true) {
-      previous = prev[previous].first;
-      if (previous == std::numeric_limits<Id>::max()) {
-        return std::nullopt;
-      }
+    while (previous != source) {
+      previous = prev[previous];
       path.push_back(previous);
-      if (previous == sourceId) {
-        break;
-      }
     }
 
     std::reverse(path.begin(), path.end());
-    return DijkstraResult(path, prev[destination].second);
+    return DijkstraResult(path, dist[destination]);
+  }
+
+  template <typename Func>
+    requires(std::is_same_v<std::invoke_result_t<Func, const Graph*, Id, Id>, double>)
+  const std::vector<double>& Graph::shortestDistances(Id destination,
+                                                      DijkstraWorkspace& workspace,
+                                                      Func getStreetWeight) const {
+    const size_t n_nodes{m_inOffsets.empty() ? 0 : m_inOffsets.size() - 1};
+    workspace.reset(n_nodes);
+    auto& dist{workspace.distances()};
+    if (!m_nodes.contains(destination) || destination >= n_nodes) {
+      return dist;
+    }
+    auto& next{workspace.previous()};
+
+    dist[destination] = 0.;
+    workspace.push(destination, 0.);
+    while (!workspace.empty()) {
+      const auto [distance, nodeId] = workspace.pop();
+      // stale heap entry, the node has already been settled
+      if (distance > dist[nodeId]) {
+        continue;
+      }
+      for (const auto previousId : inNeighbours(nodeId)) {
+        const double newDistance{distance + getStreetWeight(this, previousId, nodeId)};
+        if (newDistance < dist[previousId]) {
+          dist[previousId] = newDistance;
+          next[previousId] = nodeId;
+          workspace.push(previousId, newDistance);
+        }
+      }
+    }
+    return dist;
   }
 };  // namespace dsm
@@ -13,6 +13,7 @@ namespace dsm {
           m_agents.size())));
     }
     Node::setCapacity(capacity);
+    m_agents.reserve(capacity);
   }
 
   void Intersection::addAgent(double angle, Id agentId) {
@@ -26,21 +27,28 @@ namespace dsm {
       }
     }
     auto iAngle{static_cast<int16_t>(angle * 100)};
-    m_agents.emplace(iAngle, agentId);
+    // insert after the agents with the same angle, to keep the arrival order
+    auto const it{std::upper_bound(
+        m_agents.begin(), m_agents.end(), iAngle, [](int16_t key, auto const& pair) {
+          return key < pair.first;
+        })};
+    m_agents.emplace(it, iAngle, agentId);
     ++m_agentCounter;
   }
 
   void Intersection::addAgent(Id agentId) {
     int lastKey{0};
     if (!m_agents.empty()) {
-      lastKey = m_agents.rbegin()->first + 1;
+      lastKey = m_agents.back().first + 1;
     }
     addAgent(static_cast<double>(lastKey), agentId);
   }
 
   void Intersection::removeAgent(Id agentId) {
-    std::erase_if(m_agents,
-                  [agentId](const auto& pair) { return pair.second == agentId; });
+    auto const it{std::ranges::find(m_agents, agentId, &std::pair<int16_t, Id>::second)};
+    if (it != m_agents.end()) {
+      m_agents.erase(it);
+    }
   }
 
   Size Intersection::agentCounter() {
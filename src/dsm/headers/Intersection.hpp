@@ -3,49 +3,53 @@
 
 /// @details This file contains the definition of the Intersection class. The Intersection class
 ///          represents a node in the road network. It is derived from the Node class and has a
-///          multimap of agents waiting to pass through the intersection. Agents are ordered by
-///          their angle difference, emulating real-world precedence.
+///          sorted array of agents waiting to pass through the intersection. Agents are ordered
+///          by their angle difference, emulating real-world precedence.
 
 #pragma once
 
 #include "Node.hpp"
 
-#include <map>
 #include <set>
+#include <utility>
+#include <vector>
 
 namespace dsm {
   /// @brief The Intersection class represents a node in the network.
   /// @tparam Id The type of the node's id. It must be an unsigned integral type.
   class Intersection : public Node {
   protected:
-    std::multimap<int16_t, Id> m_agents;
+    std::vector<std::pair<int16_t, Id>> m_agents;
     std::set<Id>
         m_streetPriorities;  // A set containing the street ids that have priority - like main roads
-    Size m_agentCounter;
+    Size m_agentCounter{0};
 
   public:
     /// @brief Construct a new Intersection object
     /// @param id The node's id
-    explicit Intersection(Id id) : Node{id} {};
+    explicit Intersection(Id id) : Node{id} { m_agents.reserve(m_capacity); };
     /// @brief Construct a new Intersection object
     /// @param id The node's id
     /// @param coords A std::pair containing the node's coordinates
-    Intersection(Id id, std::pair<double, double> coords) : Node{id, coords} {};
+    Intersection(Id id, std::pair<double, double> coords) : Node{id, coords} {
+      m_agents.reserve(m_capacity);
+    };
 
-    Intersection(Node const& node) : Node{node} {};
+    Intersection(Node const& node) : Node{node} { m_agents.reserve(m_capacity); };
 
     virtual ~Intersection() = default;
 
     /// @brief Set the node's capacity
     /// @param capacity The node's capacity
     /// @throws std::runtime_error if the capacity is smaller than the current queue size
+    /// @details The array of agents is preallocated to hold the whole capacity.
     void setCapacity(Size capacity) override;
 
     /// @brief Put an agent in the node
     /// @param agent A std::pair containing the agent's angle difference and id
     /// @details The agent's angle difference is used to order the agents in the node.
     ///          The agent with the smallest angle difference is the first one to be
-    ///          removed from the node.
+    ///          removed from the node. Agents with the same angle keep their arrival order.
     /// @throws std::runtime_error if the node is full
     void addAgent(double angle, Id agentId);
     /// @brief Put an agent in the node
@@ -73,7 +77,7 @@ namespace dsm {
     }
     /// @brief Returns true if the node is full
     /// @return bool True if the node is full
-    bool isFull() const override { return m_agents.size() == this->m_capacity; }
+    bool isFull() const final { return m_agents.size() == this->m_capacity; }
 
     /// @brief Get the node's street priorities
     /// @details This function returns a std::set containing the node's street priorities.
@@ -82,8 +86,9 @@ namespace dsm {
     /// @return std::set<Id> A std::set containing the node's street priorities
     virtual const std::set<Id>& streetPriorities() const { return m_streetPriorities; };
     /// @brief Get the node's agent ids
-    /// @return std::set<Id> A std::set containing the node's agent ids
-    const std::multimap<int16_t, Id>& agents() { return m_agents; };
+    /// @return std::vector<std::pair<int16_t, Id>> The agents' angle differences and ids,
+    /// sorted by angle difference
+    const std::vector<std::pair<int16_t, Id>>& agents() const { return m_agents; };
     /// @brief Returns the number of agents that have passed through the node
     /// @return Size The number of agents that have passed through the node
     /// @details This function returns the number of agents that have passed through the node
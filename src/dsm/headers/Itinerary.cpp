@@ -20,6 +20,9 @@ namespace dsm {
                                m_destination)));
     }
     m_path = std::move(path);
+    m_nextHops.clear();
   }
 
+  void Itinerary::setNextHops(std::vector<bool> nextHops) { m_nextHops = std::move(nextHops); }
+
 };  // namespace dsm
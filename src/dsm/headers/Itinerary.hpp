@@ -15,6 +15,7 @@
 #include <utility>
 #include <string>
 #include <format>
+#include <vector>
 
 namespace dsm {
   /// @brief The Itinerary class represents an itinerary in the network.
@@ -24,6 +25,7 @@ namespace dsm {
     Id m_id;
     Id m_destination;
     SparseMatrix<bool> m_path;
+    std::vector<bool> m_nextHops;
 
   public:
     /// @brief Construct a new Itinerary object
@@ -34,6 +36,12 @@ namespace dsm {
     /// @param path An adjacency matrix made by a SparseMatrix representing the itinerary's path
     /// @throw std::invalid_argument, if the itinerary's source or destination is not in the path's
     void setPath(SparseMatrix<bool> path);
+    /// @brief Set the itinerary's routing table
+    /// @param nextHops A bit for each street of the graph, indexed by the street's dense index
+    /// (see Graph::streetIndex), which is true if the street belongs to the itinerary's path
+    /// @details Setting a new path clears the routing table, so this function must be called
+    /// after setPath.
+    void setNextHops(std::vector<bool> nextHops);
 
     /// @brief Get the itinerary's id
     /// @return Id, The itinerary's id
@@ -45,5 +53,9 @@ namespace dsm {
     /// @return SparseMatrix<Id, bool>, An adjacency matrix made by a SparseMatrix representing the
     /// itinerary's path
     const SparseMatrix<bool>& path() const { return m_path; }
+    /// @brief Get the itinerary's routing table
+    /// @return const std::vector<bool>&, A bit for each street of the graph, indexed by the
+    /// street's dense index. It is empty if no routing table has been set.
+    const std::vector<bool>& nextHops() const { return m_nextHops; }
   };
 };  // namespace dsm
@@ -27,7 +27,10 @@
 #include "DijkstraWeights.hpp"
 #include "Itinerary.hpp"
 #include "Graph.hpp"
+#include "RoadPolicies.hpp"
 #include "SparseMatrix.hpp"
+#include "../utility/ActiveSet.hpp"
+#include "../utility/TimingWheel.hpp"
 #include "../utility/TypeTraits/is_agent.hpp"
 #include "../utility/TypeTraits/is_itinerary.hpp"
 #include "../utility/Logger.hpp"
@@ -35,71 +38,298 @@
 
 namespace dsm {
   /// @brief The RoadDynamics class represents the dynamics of the network.
-  /// @tparam Id, The type of the graph's id. It must be an unsigned integral type.
-  /// @tparam Size, The type of the graph's capacity. It must be an unsigned integral type.
-  template <typename delay_t>
+  /// @tparam delay_t, The type of the agents' delay. It must be a numeric type.
+  /// @tparam policies_t, The RoadPolicies of the dynamics: speed model, lane selection,
+  /// route choice, data update hook and intersection priorities. The speed model, the route
+  /// choice and the intersection priorities are public bases of the dynamics, so their
+  /// parameters are set through the dynamics.
+  template <typename delay_t, typename policies_t = RoadPolicies<>>
     requires(is_numeric_v<delay_t>)
-  class RoadDynamics : public Dynamics<Agent<delay_t>> {
+  class RoadDynamics : public Dynamics<Agent<delay_t>>,
+                       public policies_t::speed_model,
+                       public policies_t::route_choice,
+                       public policies_t::intersection_priorities {
   protected:
+    /// @brief The kind of a node, used to dispatch without RTTI in the evolution
+    enum class NodeKind : uint8_t { OTHER, INTERSECTION, TRAFFIC_LIGHT, ROUNDABOUT };
+    using Draw = typename Dynamics<Agent<delay_t>>::Draw;
+    /// @brief A move out of a street, gathered in the first phase of the two-phase evolution
+    struct StreetMove {
+      Size rank;  // position of the agent in its lane
+      Size streetIndex;
+      int16_t queueIndex;
+      Id agentId;
+      bool bNextStreetFull;
+    };
+    /// @brief A move out of a node, gathered in the first phase of the two-phase evolution
+    struct NodeMove {
+      Id nodeId;
+      Size rank;  // position of the agent in the node
+      Id agentId;
+      Size nextStreetIndex;
+    };
+    /// @brief A region of the network, evolved by a single worker in the two-phase evolution
+    /// @details A partition owns a contiguous range of node ids, the streets entering them
+    /// and the exit queues of those streets. The changes which cross the boundary of the
+    /// partition are collected in its mailboxes and applied after all the workers are done.
+    struct Partition {
+      Id firstNode;
+      Id lastNode;  // one past the last node
+      std::vector<Size> streets;  // dense indices of the streets entering the partition
+      std::vector<StreetMove> streetMoves;
+      std::vector<NodeMove> nodeMoves;
+      std::vector<Id> stoppedLanes;
+      // mailboxes
+      std::vector<Id> enteredNodes;
+      std::vector<Id> arrivedAgents;
+      std::vector<std::pair<Id, Size>> departures;  // agent id and dense street index
+    };
+
+    [[no_unique_address]] typename policies_t::lane_selection m_laneSelection;
+    [[no_unique_address]] typename policies_t::data_update m_dataUpdate;
     Time m_previousOptimizationTime;
-    double m_errorProbability;
     double m_passageProbability;
     std::vector<double> m_travelTimes;
-    std::unordered_map<Id, Id> m_agentNextStreetId;
-    bool m_forcePriorities;
     std::optional<delay_t> m_dataUpdatePeriod;
-    std::unordered_map<Id, std::array<unsigned long long, 4>> m_turnCounts;
+    // per-street statistics, indexed by the dense street index
+    std::vector<std::array<unsigned long long, 4>> m_turnCounts;
     std::unordered_map<Id, std::array<long, 4>> m_turnMapping;
-    std::unordered_map<Id, Size> m_streetTails;
+    std::vector<Size> m_streetTails;
+    std::vector<Size> m_candidateOffsets;
+    std::vector<Size> m_candidateStreets;
+    bool m_bEventDriven;
+    TimingWheel m_arrivals;
+    // indexed by the agents' slots in the store
+    std::vector<Time> m_transitStarts;
+    std::vector<Id> m_idleAgents;
+    // indexed by the agents' slots in the store
+    std::vector<Size> m_idleIndices;
+    std::vector<Id> m_dueAgents;
+    ActiveSet m_activeStreets;
+    ActiveSet m_queuedStreets;
+    ActiveSet m_activeNodes;
+    std::vector<NodeKind> m_nodeKinds;
+    std::vector<TrafficLight*> m_trafficLights;
+    std::vector<Size> m_laneOffsets;
+    std::vector<Size> m_laneStreets;
+    std::vector<bool> m_blockedLanes;
+    std::vector<std::vector<Id>> m_streetWaiters;
+    std::vector<std::vector<Id>> m_nodeWaiters;
+    TimingWheel m_greenWakes;
+    std::vector<Id> m_wokenLanes;
+    bool m_bTwoPhase;
+    Size m_nPartitions;
+    std::vector<Partition> m_partitions;
+    std::vector<Size> m_streetBudgets;
+    std::vector<Size> m_nodeBudgets;
+    std::vector<uint8_t> m_stoppedLaneFlags;
 
+    /// @brief Build the lists of candidate moves
+    /// @details For every street, in dense order, the list contains the dense indices of the
+    /// streets an agent coming from it can take, U-turns excluded. U-turns are kept in
+    /// roundabouts and when they are the only possible move. The lists of the nodes follow,
+    /// containing all the streets leaving each node, for agents which have no incoming street.
+    void m_buildCandidateMoves();
+    /// @brief Build the sets of streets and nodes holding agents, and the list of traffic lights
+    /// @details Streets are indexed by their dense index, nodes by their id. A street is
+    /// active while one of its exit queues is neither empty nor blocked, a node while it
+    /// holds agents. The lanes of all the streets are numbered consecutively, in dense order.
+    void m_buildActiveSets();
+    /// @brief Check if a node is full, without virtual calls for intersections and roundabouts
+    /// @param nodeId The id of the node
+    bool m_isNodeFull(Id nodeId) const;
+    /// @brief Check if a node holds agents
+    /// @param nodeId The id of the node
+    /// @return bool True if the node is an intersection or a roundabout holding agents
+    bool m_nodeHasAgents(Id nodeId) const;
+    /// @brief Park a lane until its blocker wakes it up
+    /// @param lane The lane's number
+    /// @param waiters The wait list of the blocker, or nullptr if the lane is woken by the
+    /// timing wheel of the traffic lights
+    void m_blockLane(Id lane, std::vector<Id>* waiters);
+    /// @brief Wake up the lanes of a wait list, emptying it
+    /// @param waiters The wait list
+    void m_wakeLanes(std::vector<Id>& waiters);
+    /// @brief Wake up all the blocked lanes
+    void m_wakeAllLanes();
+    /// @brief Check if a street has a lane which is neither empty nor blocked
+    /// @param streetIndex The dense index of the street
+    bool m_hasRunnableLane(Size streetIndex) const;
+    /// @brief Set the speed of an agent to zero
+    /// @param agentId The id of the agent
+    /// @details If the agent was moving along a street, the street's speed sum is updated.
+    void m_stopAgent(Id agentId);
     /// @brief Get the next street id
     /// @param agentId The id of the agent
     /// @param NodeId The id of the node
     /// @param streetId The id of the incoming street
     /// @return Id The id of the randomly selected next street
-    virtual Id m_nextStreetId(Id agentId,
-                              Id NodeId,
-                              std::optional<Id> streetId = std::nullopt);
+    Id m_nextStreetId(Id agentId, Id NodeId, std::optional<Id> streetId = std::nullopt);
     /// @brief Increase the turn counts
-    virtual void m_increaseTurnCounts(Id streetId, double delta);
+    /// @param streetIndex The dense index of the street the agent is leaving
+    /// @param delta The angle between the street and the next one
+    virtual void m_increaseTurnCounts(Size streetIndex, double delta);
     /// @brief Evolve a street
-    /// @param pStreet A std::unique_ptr to the street
+    /// @param pStreet A pointer to the street
     /// @param reinsert_agents If true, the agents are reinserted in the simulation after they reach their destination
     /// @details If possible, removes the first agent of the street's queue, putting it in the destination node.
     /// If the agent is going into the destination node, it is removed from the simulation (and then reinserted if reinsert_agents is true)
-    void m_evolveStreet(const std::unique_ptr<Street>& pStreet,
+    void m_evolveStreet(Street* pStreet,
                         bool reinsert_agents) override;
+    /// @brief Evolve a street, visiting its lanes round-robin for a number of passes
+    /// @param streetIndex The dense index of the street
+    /// @param nPasses The number of passes, i.e. the street's transport capacity
+    /// @param reinsert_agents If true, the agents are reinserted in the simulation after they reach their destination
+    /// @details Each pass moves at most the first agent of each lane. The lookups of the
+    /// street and of its destination node are done once, and the passes stop as soon as
+    /// one of them finds no agent ready to leave.
+    void m_evolveStreet(Size streetIndex, Size nPasses, bool reinsert_agents);
     /// @brief If possible, removes one agent from the node, putting it on the next street.
-    /// @param pNode A std::unique_ptr to the node
+    /// @param pNode A pointer to the node
     /// @return bool True if the agent has been moved, false otherwise
-    bool m_evolveNode(const std::unique_ptr<Node>& pNode) override;
+    bool m_evolveNode(Node* pNode) override;
+    /// @brief Move up to a number of agents from the node to their next streets
+    /// @param pNode A pointer to the node
+    /// @param maxAgents The maximum number of agents to move
+    /// @return Size The number of agents moved
+    /// @details The agents of an intersection are visited in a single pass.
+    Size m_evolveNode(Node* pNode, Size maxAgents);
+    /// @brief Put an agent, just dequeued from a street, in the street's destination node
+    /// @param agentId The id of the agent
+    /// @param streetIndex The dense index of the street
+    /// @param pNextStreet A pointer to the street the agent is heading to
+    /// @details The node is not marked as active.
+    void m_enterNode(Id agentId, Size streetIndex, Street* pNextStreet);
+    /// @brief Put an agent, just removed from a node, on its next street
+    /// @param agentId The id of the agent
+    /// @param pStreet A pointer to the street
+    void m_enterStreet(Id agentId, Street* pStreet);
+    /// @brief Count the turn of an agent leaving a roundabout
+    /// @param agentId The id of the agent
+    /// @param pNextStreet A pointer to the street the agent is heading to
+    void m_countRoundaboutTurn(Id agentId, Street const* pNextStreet);
+    /// @brief Record the travel time of an agent which has reached its destination
+    /// @param agentId The id of the agent
+    /// @param reinsert_agents If true, the agent is reset, otherwise it is removed
+    void m_agentArrived(Id agentId, bool reinsert_agents);
+    /// @brief Gather the moves out of a street, for the two-phase evolution
+    /// @param streetIndex The dense index of the street
+    /// @param moves The vector the moves are appended to
+    /// @details At most transport capacity agents are taken from the front of each lane,
+    /// stopping at the first one which is still travelling.
+    void m_gatherStreetMoves(Size streetIndex, std::vector<StreetMove>& moves) const;
+    /// @brief Gather the moves out of a node, for the two-phase evolution
+    /// @param nodeId The id of the node
+    /// @param moves The vector the moves are appended to
+    void m_gatherNodeMoves(Id nodeId, std::vector<NodeMove>& moves) const;
+    /// @brief Get the number of agents a node can still take
+    /// @param nodeId The id of the node
+    Size m_nodeFreeSlots(Id nodeId) const;
+    /// @brief Split the network in partitions, for the two-phase evolution
+    /// @details The nodes are split in contiguous ranges of ids, balancing the number of
+    /// nodes plus the number of lanes entering them.
+    void m_buildPartitions();
+    /// @brief Gather the moves of a partition and the free places they compete for
+    /// @param partition The partition
+    /// @details Only the partition's own state is written, so all the partitions can be
+    /// gathered concurrently.
+    void m_gatherMoves(Partition& partition);
+    /// @brief Apply the gathered moves of a partition
+    /// @param partition The partition
+    /// @details The moves out of the streets are applied first, by rank, then by street
+    /// index and lane. The moves out of the nodes follow, by node id and rank. The changes
+    /// to the state of other partitions are left in the partition's mailboxes.
+    void m_applyMoves(Partition& partition);
+    /// @brief Move the agents out of the streets and nodes in two phases
+    /// @param reinsert_agents If true, the agents are reinserted in the simulation after they reach their destination
+    void m_evolveTwoPhase(bool reinsert_agents);
     /// @brief Evolve the agents.
     /// @details Puts all new agents on a street, if possible, decrements all delays
     /// and increments all travel times.
     void m_evolveAgents() override;
+    /// @brief Enqueue an agent which has reached the end of its street
+    /// @param agentId The id of the agent
+    /// @param pStreet A pointer to the street
+    /// @details The lane is chosen according to the agent's next street.
+    void m_enqueueAgent(Id agentId, Street* pStreet);
+    /// @brief Try to put an agent which is not on a street in its source node
+    /// @param agentId The id of the agent
+    /// @return bool True if the agent has entered the node, false otherwise
+    bool m_insertAgent(Id agentId);
+    /// @brief Notify that an agent has entered a street
+    /// @param agentId The id of the agent
+    /// @details In event-driven mode, the agent's arrival is scheduled when its delay runs out.
+    void m_agentDeparted(Id agentId);
+    void m_agentAdded(Id agentId) override;
+    void m_agentRemoved(Id agentId) override;
+    /// @brief Add an agent to the list of agents which are not travelling along a street
+    void m_addIdleAgent(Id agentId);
+    /// @brief Remove an agent from the list of agents which are not travelling along a street
+    void m_removeIdleAgent(Id agentId);
+    /// @brief Evolve the agents in event-driven mode
+    /// @details Only the agents whose arrival is due and the agents which are not travelling
+    /// along a street are visited. The delay, distance and time of a travelling agent are
+    /// brought up to date when it reaches the end of its street.
+    void m_evolveAgentsEventDriven();
 
   public:
     /// @brief Construct a new RoadDynamics object
     /// @param graph The graph representing the network
     /// @param seed The seed for the random number generator
-    RoadDynamics(Graph& graph, std::optional<unsigned int> seed);
+    /// @param speedModelArgs The arguments of the speed model's constructor
+    /// @throw std::overflow_error If the time needed to cross a street at the minimum speed
+    /// does not fit in delay_t
+    template <typename... TArgs>
+    explicit RoadDynamics(Graph& graph,
+                          std::optional<unsigned int> seed = std::nullopt,
+                          TArgs&&... speedModelArgs);
 
-    /// @brief Set the error probability
-    /// @param errorProbability The error probability
-    /// @throw std::invalid_argument If the error probability is not between 0 and 1
-    void setErrorProbability(double errorProbability);
+    /// @brief Set the speed of an agent, according to the speed model
+    /// @param agentId The id of the agent
+    void setAgentSpeed(Size agentId) final;
 
     void setPassageProbability(double passageProbability);
-    /// @brief Set the force priorities flag
-    /// @param forcePriorities The flag
-    /// @details If true, if an agent cannot move to the next street, the whole node is skipped
-    void setForcePriorities(bool forcePriorities) { m_forcePriorities = forcePriorities; }
     /// @brief Set the data update period.
     /// @param dataUpdatePeriod delay_t, The period
     /// @details Some data, i.e. the street queue lengths, are stored only after a fixed amount of time which is represented by this variable.
     void setDataUpdatePeriod(delay_t dataUpdatePeriod) {
       m_dataUpdatePeriod = dataUpdatePeriod;
     }
+    /// @brief Enable or disable the event-driven evolution of the agents
+    /// @param eventDriven If true, the agents travelling along a street are scheduled in a
+    /// timing wheel and only visited when they reach the end of the street
+    /// @details The evolution is the same in both modes. In event-driven mode, however, the
+    /// delay, distance and time of an agent travelling along a street are only updated when
+    /// it reaches the end of the street. The mode can be changed at any time.
+    void setEventDriven(bool eventDriven);
+    /// @brief Check if the event-driven evolution is enabled
+    /// @return bool True if the event-driven evolution is enabled, false otherwise
+    bool isEventDriven() const { return m_bEventDriven; }
+    /// @brief Enable or disable the two-phase evolution of the streets and nodes
+    /// @param twoPhase If true, the moves out of the streets and nodes are first gathered
+    /// from the state at the beginning of the step, then applied
+    /// @details In the second phase, the moves compete for the free places of nodes and
+    /// streets following a fixed priority: the agents closer to the front of their lane
+    /// come first, then the streets with lower dense index, then the lanes from the right.
+    /// The free places are those at the beginning of the step, so a place freed during a
+    /// step is only taken at the next one. As a consequence, the result of a step does not
+    /// depend on the order streets and nodes are visited in. The mode can be changed at
+    /// any time.
+    void setTwoPhase(bool twoPhase);
+    /// @brief Check if the two-phase evolution is enabled
+    /// @return bool True if the two-phase evolution is enabled, false otherwise
+    bool isTwoPhase() const { return m_bTwoPhase; }
+    /// @brief Set the number of partitions the network is split into
+    /// @param nPartitions The number of partitions
+    /// @throw std::invalid_argument If the number of partitions is zero
+    /// @details In two-phase evolution, the partitions are evolved concurrently on the
+    /// thread pool. The random decisions are keyed by agent and time, and the changes
+    /// crossing partitions are applied in partition order, so the results do not depend
+    /// on the number of threads.
+    void setPartitions(Size nPartitions);
+    /// @brief Get the number of partitions the network is split into
+    /// @return Size The number of partitions
+    Size nPartitions() const { return m_nPartitions; }
 
     /// @brief Add a set of agents to the simulation
     /// @param nAgents The number of agents to add
@@ -126,6 +356,9 @@ namespace dsm {
     /// If the error probability is not zero, the agents can move to a random street.
     /// If the agent is in the destination node, it is removed from the simulation (and then reinserted if reinsert_agents is true)
     /// - Cycle over agents and update their times
+    /// Only the streets with non-empty queues and the nodes holding agents are visited. A
+    /// queue whose first agent is blocked by a full node, a full street or a red light is
+    /// parked until the blocker frees up or the light turns green.
     /// @param reinsert_agents If true, the agents are reinserted in the simulation after they reach their destination
     void evolve(bool reinsert_agents = false) override;
     /// @brief Optimize the traffic lights by changing the green and red times
@@ -144,11 +377,10 @@ namespace dsm {
     /// @return Measurement<double> The mean travel time of the agents and the standard
     Measurement<double> meanTravelTime(bool clearData = false);
     /// @brief Get the turn counts of the agents
-    /// @return const std::array<unsigned long long, 3>& The turn counts
+    /// @return std::unordered_map<Id, std::array<unsigned long long, 4>> The turn counts of
+    /// each street
     /// @details The array contains the counts of left (0), straight (1), right (2) and U (3) turns
-    const std::unordered_map<Id, std::array<unsigned long long, 4>>& turnCounts() const {
-      return m_turnCounts;
-    }
+    std::unordered_map<Id, std::array<unsigned long long, 4>> turnCounts() const;
     /// @brief Get the turn probabilities of the agents
     /// @return std::array<double, 3> The turn probabilities
     /// @details The array contains the probabilities of left (0), straight (1), right (2) and U (3) turns
@@ -157,24 +389,58 @@ namespace dsm {
     std::unordered_map<Id, std::array<long, 4>> turnMapping() const {
       return m_turnMapping;
     }
+
+    /// @brief Get the mean speed of a street in \f$m/s\f$
+    /// @return double The mean speed of the street or street->maxSpeed() if the street is empty
+    /// @details The agents waiting in the street's destination node are counted. If no agent
+    /// is waiting at the end of the street, the speeds are given by the speed model.
+    double streetMeanSpeed(Id streetId) const override;
+    /// @brief Get the mean speed of the streets in \f$m/s\f$
+    /// @return Measurement The mean speed of the agents and the standard deviation
+    Measurement<double> streetMeanSpeed() const override;
+    /// @brief Get the mean speed of the streets with density above or below a threshold in \f$m/s\f$
+    /// @param threshold The density threshold to consider
+    /// @param above If true, the function returns the mean speed of the streets with a density above the threshold, otherwise below
+    /// @return Measurement The mean speed of the agents and the standard deviation
+    Measurement<double> streetMeanSpeed(double threshold, bool above) const override;
   };
 
-  template <typename delay_t>
+  template <typename delay_t, typename policies_t>
     requires(is_numeric_v<delay_t>)
-  RoadDynamics<delay_t>::RoadDynamics(Graph& graph, std::optional<unsigned int> seed)
+  template <typename... TArgs>
+  RoadDynamics<delay_t, policies_t>::RoadDynamics(Graph& graph,
+                                                  std::optional<unsigned int> seed,
+                                                  TArgs&&... speedModelArgs)
       : Dynamics<Agent<delay_t>>(graph, seed),
+        policies_t::speed_model(std::forward<TArgs>(speedModelArgs)...),
         m_previousOptimizationTime{0},
-        m_errorProbability{0.},
         m_passageProbability{1.},
-        m_forcePriorities{false} {
+        m_bEventDriven{false},
+        m_bTwoPhase{false},
+        m_nPartitions{1} {
+    double maxTimePenalty{0.};
+    for (auto const* pStreet : this->m_graph.streets()) {
+      maxTimePenalty = std::max(
+          maxTimePenalty, std::ceil(pStreet->length() / this->minSpeed(*pStreet)));
+    }
+    if (maxTimePenalty > static_cast<double>(std::numeric_limits<delay_t>::max())) {
+      throw std::overflow_error(
+          buildLog(std::format("The maximum time penalty ({}) is greater than the "
+                               "maximum value of delay_t ({})",
+                               maxTimePenalty,
+                               std::numeric_limits<delay_t>::max())));
+    }
+    this->m_buildCandidateMoves();
+    this->m_buildActiveSets();
+    m_streetTails.assign(this->m_graph.streets().size(), 0);
+    m_turnCounts.assign(this->m_graph.streets().size(),
+                        std::array<unsigned long long, 4>{0, 0, 0, 0});
     for (const auto& [streetId, street] : this->m_graph.streetSet()) {
-      m_streetTails.emplace(streetId, 0);
-      m_turnCounts.emplace(streetId, std::array<unsigned long long, 4>{0, 0, 0, 0});
       // fill turn mapping as [streetId, [left street Id, straight street Id, right street Id, U self street Id]]
       m_turnMapping.emplace(streetId, std::array<long, 4>{-1, -1, -1, -1});
       // Turn mappings
       const auto& srcNodeId = street->nodePair().second;
-      for (const auto& [ss, _] : this->m_graph.adjMatrix().getRow(srcNodeId, true)) {
+      for (const auto ss : this->m_graph.outStreets(srcNodeId)) {
         const auto& delta = street->angle() - this->m_graph.streetSet()[ss]->angle();
         if (std::abs(delta) < std::numbers::pi) {
           if (delta < 0.) {
@@ -192,192 +458,805 @@ namespace dsm {
     }
   }
 
-  template <typename delay_t>
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_buildCandidateMoves() {
+    auto const& streets{this->m_graph.streets()};
+    auto const& nodes{this->m_graph.nodes()};
+    m_candidateOffsets.clear();
+    m_candidateStreets.clear();
+    m_candidateOffsets.reserve(streets.size() + nodes.size() + 1);
+    m_candidateOffsets.push_back(0);
+    for (auto const* pStreet : streets) {
+      auto const [srcNodeId, dstNodeId] = pStreet->nodePair();
+      auto const offset{this->m_graph.outStreetsOffset(dstNodeId)};
+      auto const outNeighbours{this->m_graph.outNeighbours(dstNodeId)};
+      for (Size i{0}; i < outNeighbours.size(); ++i) {
+        if (outNeighbours[i] != srcNodeId || nodes[dstNodeId]->isRoundabout() ||
+            outNeighbours.size() == 1) {
+          m_candidateStreets.push_back(offset + i);
+        }
+      }
+      m_candidateOffsets.push_back(static_cast<Size>(m_candidateStreets.size()));
+    }
+    for (Id nodeId{0}; nodeId < nodes.size(); ++nodeId) {
+      auto const offset{this->m_graph.outStreetsOffset(nodeId)};
+      for (Size i{0}; i < this->m_graph.outStreets(nodeId).size(); ++i) {
+        m_candidateStreets.push_back(offset + i);
+      }
+      m_candidateOffsets.push_back(static_cast<Size>(m_candidateStreets.size()));
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
     requires(is_numeric_v<delay_t>)
-  Id RoadDynamics<delay_t>::m_nextStreetId(Id agentId,
+  void RoadDynamics<delay_t, policies_t>::m_buildActiveSets() {
+    auto const& streets{this->m_graph.streets()};
+    auto const& nodes{this->m_graph.nodes()};
+    m_activeStreets.resize(streets.size());
+    for (Size index{0}; index < streets.size(); ++index) {
+      if (streets[index]->nExitingAgents() > 0) {
+        m_activeStreets.insert(index);
+      }
+    }
+    m_queuedStreets.resize(streets.size());
+    m_laneOffsets.assign(1, 0);
+    m_laneStreets.clear();
+    for (Size index{0}; index < streets.size(); ++index) {
+      if (streets[index]->nExitingAgents() > 0) {
+        m_queuedStreets.insert(index);
+      }
+      m_laneOffsets.push_back(m_laneOffsets.back() + streets[index]->nLanes());
+      m_laneStreets.insert(m_laneStreets.end(), streets[index]->nLanes(), index);
+    }
+    m_blockedLanes.assign(m_laneStreets.size(), false);
+    m_streetWaiters.assign(streets.size(), {});
+    m_nodeWaiters.assign(nodes.size(), {});
+    m_greenWakes.clear();
+    m_streetBudgets.assign(streets.size(), 0);
+    m_nodeBudgets.assign(nodes.size(), 0);
+    m_stoppedLaneFlags.assign(m_laneStreets.size(), 0);
+    // the partitions are rebuilt on the next two-phase step
+    m_partitions.clear();
+    m_activeNodes.resize(nodes.size());
+    m_nodeKinds.assign(nodes.size(), NodeKind::OTHER);
+    m_trafficLights.clear();
+    for (auto* const pNode : nodes) {
+      if (pNode == nullptr) {
+        continue;
+      }
+      if (pNode->isTrafficLight()) {
+        m_nodeKinds[pNode->id()] = NodeKind::TRAFFIC_LIGHT;
+        m_trafficLights.push_back(static_cast<TrafficLight*>(pNode));
+      } else if (pNode->isIntersection()) {
+        m_nodeKinds[pNode->id()] = NodeKind::INTERSECTION;
+      } else if (pNode->isRoundabout()) {
+        m_nodeKinds[pNode->id()] = NodeKind::ROUNDABOUT;
+      }
+      if (this->m_nodeHasAgents(pNode->id())) {
+        m_activeNodes.insert(pNode->id());
+      }
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  bool RoadDynamics<delay_t, policies_t>::m_isNodeFull(Id nodeId) const {
+    auto* const pNode{this->m_graph.nodes()[nodeId]};
+    switch (m_nodeKinds[nodeId]) {
+      case NodeKind::INTERSECTION:
+      case NodeKind::TRAFFIC_LIGHT:
+        return static_cast<const Intersection*>(pNode)->isFull();
+      case NodeKind::ROUNDABOUT:
+        return static_cast<const Roundabout*>(pNode)->isFull();
+      default:
+        return pNode->isFull();
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  bool RoadDynamics<delay_t, policies_t>::m_nodeHasAgents(Id nodeId) const {
+    auto* const pNode{this->m_graph.nodes()[nodeId]};
+    switch (m_nodeKinds[nodeId]) {
+      case NodeKind::INTERSECTION:
+      case NodeKind::TRAFFIC_LIGHT:
+        return !static_cast<Intersection*>(pNode)->agents().empty();
+      case NodeKind::ROUNDABOUT:
+        return !static_cast<const Roundabout*>(pNode)->agents().empty();
+      default:
+        return false;
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_blockLane(Id lane, std::vector<Id>* waiters) {
+    m_blockedLanes[lane] = true;
+    if (waiters != nullptr) {
+      waiters->push_back(lane);
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_wakeLanes(std::vector<Id>& waiters) {
+    for (auto const lane : waiters) {
+      if (m_blockedLanes[lane]) {
+        m_blockedLanes[lane] = false;
+        m_activeStreets.insert(m_laneStreets[lane]);
+      }
+    }
+    waiters.clear();
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_stopAgent(Id agentId) {
+    auto const& agent{this->m_agents[agentId]};
+    if (agent->speed() > 0. && agent->streetId().has_value()) {
+      this->m_graph.streetSet().at(agent->streetId().value())->stopAgent(agent->speed());
+    }
+    agent->setSpeed(0.);
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_wakeAllLanes() {
+    for (Id lane{0}; lane < m_blockedLanes.size(); ++lane) {
+      if (m_blockedLanes[lane]) {
+        m_blockedLanes[lane] = false;
+        m_activeStreets.insert(m_laneStreets[lane]);
+      }
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  bool RoadDynamics<delay_t, policies_t>::m_hasRunnableLane(Size streetIndex) const {
+    auto const* pStreet{this->m_graph.streets()[streetIndex]};
+    auto const firstLane{m_laneOffsets[streetIndex]};
+    for (auto queueIndex = 0; queueIndex < pStreet->nLanes(); ++queueIndex) {
+      if (!pStreet->queue(queueIndex).empty() && !m_blockedLanes[firstLane + queueIndex]) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  Id RoadDynamics<delay_t, policies_t>::m_nextStreetId(Id agentId,
                                            Id nodeId,
                                            std::optional<Id> streetId) {
     auto const& pAgent{this->m_agents[agentId]};
-    auto possibleMoves = this->m_graph.adjMatrix().getRow(nodeId, true);
+    auto const& streets{this->m_graph.streets()};
+    auto const candidatesOf = [this](Size index) {
+      return std::span<const Size>(m_candidateStreets)
+          .subspan(m_candidateOffsets[index],
+                   m_candidateOffsets[index + 1] - m_candidateOffsets[index]);
+    };
+    auto const nodeCandidates{candidatesOf(static_cast<Size>(streets.size()) + nodeId)};
+    auto candidates{streetId.has_value()
+                        ? candidatesOf(this->m_graph.streetIndex(streetId.value()))
+                        : nodeCandidates};
+    // the error and the move are drawn with a single call to the generator
+    auto const [errorDraw, moveDraw] = this->m_uniformPair(agentId, Draw::NEXT_STREET);
     if (!pAgent->isRandom()) {
-      std::uniform_real_distribution<double> uniformDist{0., 1.};
-      if (this->m_itineraries.size() > 0 &&
-          uniformDist(this->m_generator) > m_errorProbability) {
-        const auto& it = this->m_itineraries[pAgent->itineraryId()];
+      if (this->m_itineraries.size() > 0 && this->followsItinerary(errorDraw)) {
+        const auto& it = this->m_agentItinerary(pAgent);
         if (it->destination() != nodeId) {
-          possibleMoves = it->path().getRow(nodeId, true);
+          auto const& nextHops{it->nextHops()};
+          auto const isOnPath = [&](Size index) {
+            if (!nextHops.empty()) {
+              return static_cast<bool>(nextHops[index]);
+            }
+            // no routing table, e.g. the path has been set by hand
+            return it->path().contains(nodeId, streets[index]->nodePair().second);
+          };
+          auto nMoves{
+              static_cast<Size>(std::count_if(candidates.begin(), candidates.end(), isOnPath))};
+          if (nMoves == 0) {
+            // the only way to the destination is a U-turn
+            candidates = nodeCandidates;
+            nMoves = static_cast<Size>(
+                std::count_if(candidates.begin(), candidates.end(), isOnPath));
+          }
+          assert(nMoves > 0);
+          auto move{this->m_toIndex(moveDraw, nMoves)};
+          for (auto const index : candidates) {
+            if (isOnPath(index) && move-- == 0) {
+              return streets[index]->id();
+            }
+          }
         }
       }
     }
-    assert(possibleMoves.size() > 0);
-    std::uniform_int_distribution<Size> moveDist{
-        0, static_cast<Size>(possibleMoves.size() - 1)};
-    uint8_t p{0};
-    auto iterator = possibleMoves.begin();
-    // while loop to avoid U turns in non-roundabout junctions
-    do {
-      p = moveDist(this->m_generator);
-      iterator = possibleMoves.begin();
-      std::advance(iterator, p);
-    } while (!this->m_graph.nodeSet().at(nodeId)->isRoundabout() and
-             streetId.has_value() and
-             (this->m_graph.streetSet()[iterator->first]->nodePair().second ==
-              this->m_graph.streetSet()[streetId.value()]->nodePair().first) and
-             (possibleMoves.size() > 1));
-    return iterator->first;
+    assert(candidates.size() > 0);
+    auto const move{this->m_toIndex(moveDraw, static_cast<Size>(candidates.size()))};
+    return streets[candidates[move]]->id();
   }
 
-  template <typename delay_t>
+  template <typename delay_t, typename policies_t>
     requires(is_numeric_v<delay_t>)
-  void RoadDynamics<delay_t>::m_increaseTurnCounts(Id streetId, double delta) {
+  void RoadDynamics<delay_t, policies_t>::m_increaseTurnCounts(Size streetIndex, double delta) {
     if (std::abs(delta) < std::numbers::pi) {
       if (delta < 0.) {
-        ++m_turnCounts[streetId][0];  // right
+        ++m_turnCounts[streetIndex][0];  // right
       } else if (delta > 0.) {
-        ++m_turnCounts[streetId][2];  // left
+        ++m_turnCounts[streetIndex][2];  // left
       } else {
-        ++m_turnCounts[streetId][1];  // straight
+        ++m_turnCounts[streetIndex][1];  // straight
       }
     } else {
-      ++m_turnCounts[streetId][3];  // U
+      ++m_turnCounts[streetIndex][3];  // U
     }
   }
 
-  template <typename delay_t>
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_evolveStreet(Street* pStreet,
+                                             bool reinsert_agents) {
+    this->m_evolveStreet(this->m_graph.streetIndex(pStreet->id()), 1, reinsert_agents);
+  }
+
+  template <typename delay_t, typename policies_t>
     requires(is_numeric_v<delay_t>)
-  void RoadDynamics<delay_t>::m_evolveStreet(const std::unique_ptr<Street>& pStreet,
+  void RoadDynamics<delay_t, policies_t>::m_evolveStreet(Size streetIndex,
+                                             Size nPasses,
                                              bool reinsert_agents) {
+    auto* const pStreet{this->m_graph.streets()[streetIndex]};
     auto const nLanes = pStreet->nLanes();
-    std::uniform_real_distribution<double> uniformDist{0., 1.};
-    for (auto queueIndex = 0; queueIndex < nLanes; ++queueIndex) {
-      if (pStreet->queue(queueIndex).empty()) {
-        continue;
+    auto const firstLane{m_laneOffsets[streetIndex]};
+    auto const destinationId{pStreet->nodePair().second};
+    auto const destinationKind{m_nodeKinds[destinationId]};
+    auto* const destinationNode{this->m_graph.nodes()[destinationId]};
+    for (Size pass{0}; pass < nPasses; ++pass) {
+      // a pass which finds no agent ready to leave would be repeated identically
+      bool bTouched{false};
+      for (auto queueIndex = 0; queueIndex < nLanes; ++queueIndex) {
+        auto const lane{static_cast<Id>(firstLane + queueIndex)};
+        if (pStreet->queue(queueIndex).empty() || m_blockedLanes[lane]) {
+          continue;
+        }
+        const auto agentId{pStreet->queue(queueIndex).front()};
+        auto const& pAgent{this->m_agents[agentId]};
+        if (pAgent->delay() > 0) {
+          continue;
+        }
+        bTouched = true;
+        this->m_stopAgent(agentId);
+        if (this->m_isNodeFull(destinationId)) {
+          this->m_blockLane(lane, &m_nodeWaiters[destinationId]);
+          continue;
+        }
+        if (destinationKind == NodeKind::TRAFFIC_LIGHT) {
+          auto& tl = static_cast<TrafficLight&>(*destinationNode);
+          auto const direction{pStreet->laneMapping().at(queueIndex)};
+          if (!tl.isGreen(pStreet->id(), direction)) {
+            // a light which is never green is only woken when the cycles change
+            this->m_blockLane(lane, nullptr);
+            if (auto const ticks = tl.ticksToGreen(pStreet->id(), direction)) {
+              m_greenWakes.schedule(lane, this->m_time + ticks.value());
+            }
+            continue;
+          }
+        }
+        // an agent denied passage tries again, with a new draw, at the next pass
+        auto const bCanPass =
+            this->m_uniform(agentId, Draw::PASSAGE, pass) < m_passageProbability;
+        bool bArrived{false};
+        if (!bCanPass) {
+          if (pAgent->isRandom()) {
+            pAgent->setNextStreetId(std::nullopt);
+            bArrived = true;
+          } else {
+            continue;
+          }
+        }
+        if (!pAgent->isRandom()) {
+          if (destinationId ==
+              this->m_agentItinerary(pAgent)->destination()) {
+            bArrived = true;
+          }
+        }
+        if (bArrived) {
+          pStreet->dequeue(queueIndex);
+          this->m_wakeLanes(m_streetWaiters[streetIndex]);
+          this->m_agentArrived(agentId, reinsert_agents);
+          continue;
+        }
+        auto const& nextStreet{this->m_graph.streetSet()[pAgent->nextStreetId().value()]};
+        if (nextStreet->isFull()) {
+          // a random agent may still leave the network, if the passage is denied
+          if (!pAgent->isRandom() || m_passageProbability >= 1.) {
+            this->m_blockLane(
+                lane, &m_streetWaiters[this->m_graph.streetIndex(nextStreet->id())]);
+          }
+          continue;
+        }
+        pStreet->dequeue(queueIndex);
+        this->m_wakeLanes(m_streetWaiters[streetIndex]);
+        m_activeNodes.insert(destinationId);
+        this->m_enterNode(agentId, streetIndex, nextStreet.get());
+      }
+      if (!bTouched) {
+        break;
+      }
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  bool RoadDynamics<delay_t, policies_t>::m_evolveNode(Node* pNode) {
+    return this->m_evolveNode(pNode, 1) > 0;
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  Size RoadDynamics<delay_t, policies_t>::m_evolveNode(Node* pNode, Size maxAgents) {
+    Size nMoved{0};
+    auto const kind{m_nodeKinds[pNode->id()]};
+    if (kind == NodeKind::INTERSECTION || kind == NodeKind::TRAFFIC_LIGHT) {
+      auto& intersection = static_cast<Intersection&>(*pNode);
+      // streets only fill up here, so an agent which cannot move now is skipped for good
+      std::size_t index{0};
+      while (nMoved < maxAgents && index < intersection.agents().size()) {
+        auto const agentId{intersection.agents()[index].second};
+        auto const& nextStreet{
+            this->m_graph.streetSet()[this->m_agents[agentId]->nextStreetId().value()]};
+        if (nextStreet->isFull()) {
+          if (this->forcePriorities()) {
+            break;
+          }
+          ++index;
+          continue;
+        }
+        intersection.removeAgent(agentId);
+        this->m_enterStreet(agentId, nextStreet.get());
+        ++nMoved;
+      }
+    } else if (kind == NodeKind::ROUNDABOUT) {
+      auto& roundabout = static_cast<Roundabout&>(*pNode);
+      while (nMoved < maxAgents && !roundabout.agents().empty()) {
+        auto const agentId{roundabout.agents().front()};
+        auto const& nextStreet{
+            this->m_graph.streetSet()[this->m_agents[agentId]->nextStreetId().value()]};
+        if (nextStreet->isFull()) {
+          break;
+        }
+        this->m_countRoundaboutTurn(agentId, nextStreet.get());
+        roundabout.dequeue();
+        this->m_enterStreet(agentId, nextStreet.get());
+        ++nMoved;
+      }
+    }
+    return nMoved;
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_enterNode(Id agentId,
+                                          Size streetIndex,
+                                          Street* pNextStreet) {
+    auto const* pStreet{this->m_graph.streets()[streetIndex]};
+    auto const nodeId{pStreet->nodePair().second};
+    assert(nodeId == pNextStreet->nodePair().first);
+    auto* const pNode{this->m_graph.nodes()[nodeId]};
+    auto const kind{m_nodeKinds[nodeId]};
+    if (kind == NodeKind::INTERSECTION || kind == NodeKind::TRAFFIC_LIGHT) {
+      auto& intersection = static_cast<Intersection&>(*pNode);
+      auto const delta{pNextStreet->deltaAngle(pStreet->angle())};
+      m_increaseTurnCounts(streetIndex, delta);
+      intersection.addAgent(delta, agentId);
+    } else if (kind == NodeKind::ROUNDABOUT) {
+      auto& roundabout = static_cast<Roundabout&>(*pNode);
+      roundabout.enqueue(agentId);
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_enterStreet(Id agentId, Street* pStreet) {
+    auto* const pAgent{this->m_agents[agentId]};
+    pAgent->setStreetId(pStreet->id());
+    this->setAgentSpeed(agentId);
+    pAgent->incrementDelay(std::ceil(pStreet->length() / pAgent->speed()));
+    this->m_agentDeparted(agentId);
+    pStreet->addAgent(agentId, pAgent->speed());
+    pAgent->setNextStreetId(std::nullopt);
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_countRoundaboutTurn(Id agentId,
+                                                    Street const* pNextStreet) {
+    auto const streetId{this->m_agents[agentId]->streetId()};
+    if (!streetId.has_value()) {
+      return;
+    }
+    auto const streetIndex{this->m_graph.streetIndex(streetId.value())};
+    auto delta = pNextStreet->angle() - this->m_graph.streets()[streetIndex]->angle();
+    if (delta > std::numbers::pi) {
+      delta -= 2 * std::numbers::pi;
+    } else if (delta < -std::numbers::pi) {
+      delta += 2 * std::numbers::pi;
+    }
+    m_increaseTurnCounts(streetIndex, delta);
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_agentArrived(Id agentId, bool reinsert_agents) {
+    m_travelTimes.push_back(this->m_agents[agentId]->time());
+    if (reinsert_agents) {
+      // reset Agent's values
+      this->m_agents[agentId]->reset();
+    } else {
+      this->removeAgent(agentId);
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_gatherStreetMoves(Size streetIndex,
+                                                  std::vector<StreetMove>& moves) const {
+    auto const* pStreet{this->m_graph.streets()[streetIndex]};
+    auto const nPasses{static_cast<Size>(std::max<int16_t>(pStreet->transportCapacity(), 0))};
+    for (int16_t queueIndex{0}; queueIndex < pStreet->nLanes(); ++queueIndex) {
+      auto const& queue{pStreet->queue(queueIndex)};
+      auto const nCandidates{std::min(nPasses, static_cast<Size>(queue.size()))};
+      for (Size rank{0}; rank < nCandidates; ++rank) {
+        auto const agentId{queue[rank]};
+        auto const* pAgent{this->m_agents[agentId]};
+        if (pAgent->delay() > 0) {
+          break;
+        }
+        auto const nextStreetId{pAgent->nextStreetId()};
+        bool const bNextStreetFull{
+            nextStreetId.has_value() &&
+            this->m_graph.streetSet().at(nextStreetId.value())->isFull()};
+        moves.push_back({rank, streetIndex, queueIndex, agentId, bNextStreetFull});
+      }
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_gatherNodeMoves(Id nodeId,
+                                                std::vector<NodeMove>& moves) const {
+    auto const* pNode{this->m_graph.nodes()[nodeId]};
+    auto const addMove = [&](Size rank, Id agentId) {
+      auto const nextStreetId{this->m_agents[agentId]->nextStreetId().value()};
+      moves.push_back({nodeId, rank, agentId, this->m_graph.streetIndex(nextStreetId)});
+    };
+    // all the agents are gathered, since blocked agents of an intersection may be skipped
+    switch (m_nodeKinds[nodeId]) {
+      case NodeKind::INTERSECTION:
+      case NodeKind::TRAFFIC_LIGHT: {
+        auto const& agents{static_cast<const Intersection*>(pNode)->agents()};
+        for (Size rank{0}; rank < agents.size(); ++rank) {
+          addMove(rank, agents[rank].second);
+        }
+        break;
+      }
+      case NodeKind::ROUNDABOUT: {
+        auto const& agents{static_cast<const Roundabout*>(pNode)->agents()};
+        for (Size rank{0}; rank < agents.size(); ++rank) {
+          addMove(rank, agents[rank]);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  Size RoadDynamics<delay_t, policies_t>::m_nodeFreeSlots(Id nodeId) const {
+    auto* const pNode{this->m_graph.nodes()[nodeId]};
+    switch (m_nodeKinds[nodeId]) {
+      case NodeKind::INTERSECTION:
+      case NodeKind::TRAFFIC_LIGHT:
+        return pNode->capacity() -
+               static_cast<Size>(static_cast<const Intersection*>(pNode)->agents().size());
+      case NodeKind::ROUNDABOUT:
+        return pNode->capacity() -
+               static_cast<Size>(static_cast<const Roundabout*>(pNode)->agents().size());
+      default:
+        return pNode->isFull() ? 0 : std::numeric_limits<Size>::max();
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_buildPartitions() {
+    auto const& streets{this->m_graph.streets()};
+    auto const nNodes{static_cast<Size>(this->m_graph.nodes().size())};
+    std::vector<Size> weights(nNodes, 1);
+    for (auto const* pStreet : streets) {
+      weights[pStreet->nodePair().second] += pStreet->nLanes();
+    }
+    auto const totalWeight{std::accumulate(weights.cbegin(), weights.cend(), Size{0})};
+    auto const nPartitions{std::max<Size>(std::min(m_nPartitions, nNodes), 1)};
+    m_partitions.clear();
+    m_partitions.resize(nPartitions);
+    std::vector<Size> nodePartitions(nNodes);
+    Id nodeId{0};
+    Size cumulatedWeight{0};
+    for (Size index{0}; index < nPartitions; ++index) {
+      auto& partition{m_partitions[index]};
+      partition.firstNode = nodeId;
+      // leave at least one node to each of the following partitions
+      auto const target{totalWeight * (index + 1) / nPartitions};
+      while (nodeId < nNodes - (nPartitions - index - 1) &&
+             (nodeId == partition.firstNode || cumulatedWeight < target)) {
+        cumulatedWeight += weights[nodeId];
+        nodePartitions[nodeId] = index;
+        ++nodeId;
+      }
+      partition.lastNode = index + 1 == nPartitions ? nNodes : nodeId;
+      for (; nodeId < partition.lastNode; ++nodeId) {
+        nodePartitions[nodeId] = index;
+      }
+    }
+    for (Size index{0}; index < streets.size(); ++index) {
+      m_partitions[nodePartitions[streets[index]->nodePair().second]].streets.push_back(
+          index);
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_gatherMoves(Partition& partition) {
+    auto const& streets{this->m_graph.streets()};
+    partition.streetMoves.clear();
+    partition.nodeMoves.clear();
+    for (auto const streetIndex : partition.streets) {
+      if (m_activeStreets.contains(streetIndex)) {
+        this->m_gatherStreetMoves(streetIndex, partition.streetMoves);
       }
-      const auto agentId{pStreet->queue(queueIndex).front()};
-      auto const& pAgent{this->m_agents[agentId]};
-      if (pAgent->delay() > 0) {
+    }
+    for (auto nodeId{partition.firstNode}; nodeId < partition.lastNode; ++nodeId) {
+      if (m_activeNodes.contains(nodeId)) {
+        this->m_gatherNodeMoves(nodeId, partition.nodeMoves);
+      }
+    }
+    std::ranges::sort(partition.streetMoves, {}, [](StreetMove const& move) {
+      return std::tuple(move.rank, move.streetIndex, move.queueIndex);
+    });
+    // the node moves are gathered by node id and rank already
+    // the free places are taken from the state at the beginning of the step
+    for (auto const& move : partition.streetMoves) {
+      auto const nodeId{streets[move.streetIndex]->nodePair().second};
+      m_nodeBudgets[nodeId] = this->m_nodeFreeSlots(nodeId);
+    }
+    for (auto const& move : partition.nodeMoves) {
+      auto const* pStreet{streets[move.nextStreetIndex]};
+      m_streetBudgets[move.nextStreetIndex] = pStreet->capacity() - pStreet->nAgents();
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_applyMoves(Partition& partition) {
+    auto const& streets{this->m_graph.streets()};
+    auto const& nodes{this->m_graph.nodes()};
+    partition.enteredNodes.clear();
+    partition.arrivedAgents.clear();
+    partition.departures.clear();
+    // a lane is stopped by the first of its agents which cannot move
+    auto const stopLane = [&](Id lane) {
+      m_stoppedLaneFlags[lane] = 1;
+      partition.stoppedLanes.push_back(lane);
+    };
+    for (auto const& move : partition.streetMoves) {
+      auto* const pStreet{streets[move.streetIndex]};
+      auto const lane{static_cast<Id>(m_laneOffsets[move.streetIndex] + move.queueIndex)};
+      if (m_stoppedLaneFlags[lane]) {
         continue;
       }
-      pAgent->setSpeed(0.);
-      const auto& destinationNode{this->m_graph.nodeSet()[pStreet->nodePair().second]};
-      if (destinationNode->isFull()) {
+      auto const agentId{move.agentId};
+      auto* const pAgent{this->m_agents[agentId]};
+      this->m_stopAgent(agentId);
+      auto const destinationId{pStreet->nodePair().second};
+      if (m_nodeBudgets[destinationId] == 0) {
+        stopLane(lane);
         continue;
       }
-      if (destinationNode->isTrafficLight()) {
-        auto& tl = dynamic_cast<TrafficLight&>(*destinationNode);
-        auto const direction{pStreet->laneMapping().at(queueIndex)};
-        if (!tl.isGreen(pStreet->id(), direction)) {
+      if (m_nodeKinds[destinationId] == NodeKind::TRAFFIC_LIGHT) {
+        auto const& tl = static_cast<const TrafficLight&>(*nodes[destinationId]);
+        if (!tl.isGreen(pStreet->id(), pStreet->laneMapping().at(move.queueIndex))) {
+          stopLane(lane);
           continue;
         }
       }
-      auto const bCanPass = uniformDist(this->m_generator) < m_passageProbability;
       bool bArrived{false};
-      if (!bCanPass) {
-        if (pAgent->isRandom()) {
-          m_agentNextStreetId.erase(agentId);
-          bArrived = true;
-        } else {
+      if (this->m_uniform(agentId, Draw::PASSAGE) >= m_passageProbability) {
+        if (!pAgent->isRandom()) {
+          stopLane(lane);
           continue;
         }
+        pAgent->setNextStreetId(std::nullopt);
+        bArrived = true;
       }
-      if (!pAgent->isRandom()) {
-        if (destinationNode->id() ==
-            this->m_itineraries[pAgent->itineraryId()]->destination()) {
-          bArrived = true;
-        }
+      if (!pAgent->isRandom() &&
+          destinationId == this->m_agentItinerary(pAgent)->destination()) {
+        bArrived = true;
       }
+      assert(pStreet->queue(move.queueIndex).front() == agentId);
       if (bArrived) {
-        pStreet->dequeue(queueIndex);
-        m_travelTimes.push_back(pAgent->time());
-        if (reinsert_agents) {
-          // reset Agent's values
-          pAgent->reset();
-        } else {
-          this->removeAgent(agentId);
-        }
+        pStreet->dequeue(move.queueIndex);
+        partition.arrivedAgents.push_back(agentId);
+        continue;
+      }
+      if (move.bNextStreetFull) {
+        stopLane(lane);
+        continue;
+      }
+      pStreet->dequeue(move.queueIndex);
+      --m_nodeBudgets[destinationId];
+      partition.enteredNodes.push_back(destinationId);
+      this->m_enterNode(
+          agentId, move.streetIndex, streets[this->m_graph.streetIndex(
+                                         pAgent->nextStreetId().value())]);
+    }
+    for (auto const lane : partition.stoppedLanes) {
+      m_stoppedLaneFlags[lane] = 0;
+    }
+    partition.stoppedLanes.clear();
+    auto stoppedNode{std::numeric_limits<Id>::max()};
+    auto currentNode{std::numeric_limits<Id>::max()};
+    Size nMoved{0};
+    for (auto const& move : partition.nodeMoves) {
+      auto* const pNode{nodes[move.nodeId]};
+      if (move.nodeId != currentNode) {
+        currentNode = move.nodeId;
+        nMoved = 0;
+      }
+      if (move.nodeId == stoppedNode || nMoved == pNode->transportCapacity()) {
         continue;
       }
-      auto const& nextStreet{this->m_graph.streetSet()[m_agentNextStreetId[agentId]]};
-      if (nextStreet->isFull()) {
+      auto const kind{m_nodeKinds[move.nodeId]};
+      if (m_streetBudgets[move.nextStreetIndex] == 0) {
+        if (kind == NodeKind::ROUNDABOUT || this->forcePriorities()) {
+          stoppedNode = move.nodeId;
+        }
         continue;
       }
-      pStreet->dequeue(queueIndex);
-      assert(destinationNode->id() == nextStreet->nodePair().first);
-      if (destinationNode->isIntersection()) {
-        auto& intersection = dynamic_cast<Intersection&>(*destinationNode);
-        auto const delta{nextStreet->deltaAngle(pStreet->angle())};
-        m_increaseTurnCounts(pStreet->id(), delta);
-        intersection.addAgent(delta, agentId);
-      } else if (destinationNode->isRoundabout()) {
-        auto& roundabout = dynamic_cast<Roundabout&>(*destinationNode);
-        roundabout.enqueue(agentId);
+      --m_streetBudgets[move.nextStreetIndex];
+      ++nMoved;
+      if (kind == NodeKind::ROUNDABOUT) {
+        auto& roundabout = static_cast<Roundabout&>(*pNode);
+        assert(roundabout.agents().front() == move.agentId);
+        this->m_countRoundaboutTurn(move.agentId, streets[move.nextStreetIndex]);
+        roundabout.dequeue();
+      } else {
+        static_cast<Intersection&>(*pNode).removeAgent(move.agentId);
       }
+      // the next street may belong to another partition
+      partition.departures.emplace_back(move.agentId, move.nextStreetIndex);
     }
   }
 
-  template <typename delay_t>
+  template <typename delay_t, typename policies_t>
     requires(is_numeric_v<delay_t>)
-  bool RoadDynamics<delay_t>::m_evolveNode(const std::unique_ptr<Node>& pNode) {
-    if (pNode->isIntersection()) {
-      auto& intersection = dynamic_cast<Intersection&>(*pNode);
-      if (intersection.agents().empty()) {
-        return false;
+  void RoadDynamics<delay_t, policies_t>::m_evolveTwoPhase(bool reinsert_agents) {
+    auto const& streets{this->m_graph.streets()};
+    if (m_partitions.empty()) {
+      this->m_buildPartitions();
+    }
+    auto const nPartitions{m_partitions.size()};
+    this->m_threadPool->parallelFor(
+        nPartitions, [this](std::size_t index) { this->m_gatherMoves(m_partitions[index]); });
+    this->m_threadPool->parallelFor(
+        nPartitions, [this](std::size_t index) { this->m_applyMoves(m_partitions[index]); });
+    // a street only receives agents from the partition of its source node
+    auto const enterStreets = [&](std::size_t index) {
+      for (auto const& [agentId, streetIndex] : m_partitions[index].departures) {
+        this->m_enterStreet(agentId, streets[streetIndex]);
       }
-      for (auto const [angle, agentId] : intersection.agents()) {
-        auto const& nextStreet{this->m_graph.streetSet()[m_agentNextStreetId[agentId]]};
-        if (nextStreet->isFull()) {
-          if (m_forcePriorities) {
-            return false;
-          }
-          continue;
-        }
-        intersection.removeAgent(agentId);
-        this->m_agents[agentId]->setStreetId(nextStreet->id());
-        this->setAgentSpeed(agentId);
-        this->m_agents[agentId]->incrementDelay(
-            std::ceil(nextStreet->length() / this->m_agents[agentId]->speed()));
-        nextStreet->addAgent(agentId);
-        m_agentNextStreetId.erase(agentId);
-        return true;
+    };
+    if (m_bEventDriven) {
+      // the arrivals are scheduled in a shared timing wheel
+      for (std::size_t index{0}; index < nPartitions; ++index) {
+        enterStreets(index);
       }
-      return false;
-    } else if (pNode->isRoundabout()) {
-      auto& roundabout = dynamic_cast<Roundabout&>(*pNode);
-      if (roundabout.agents().empty()) {
-        return false;
+    } else {
+      this->m_threadPool->parallelFor(nPartitions, enterStreets);
+    }
+    // empty the other mailboxes, in partition order
+    for (auto& partition : m_partitions) {
+      for (auto const agentId : partition.arrivedAgents) {
+        this->m_agentArrived(agentId, reinsert_agents);
       }
-      auto const agentId{roundabout.agents().front()};
-      auto const& nextStreet{this->m_graph.streetSet()[m_agentNextStreetId[agentId]]};
-      if (!(nextStreet->isFull())) {
-        if (this->m_agents[agentId]->streetId().has_value()) {
-          const auto streetId = this->m_agents[agentId]->streetId().value();
-          auto delta = nextStreet->angle() - this->m_graph.streetSet()[streetId]->angle();
-          if (delta > std::numbers::pi) {
-            delta -= 2 * std::numbers::pi;
-          } else if (delta < -std::numbers::pi) {
-            delta += 2 * std::numbers::pi;
-          }
-          m_increaseTurnCounts(streetId, delta);
-        }
-        roundabout.dequeue();
-        this->m_agents[agentId]->setStreetId(nextStreet->id());
-        this->setAgentSpeed(agentId);
-        this->m_agents[agentId]->incrementDelay(
-            std::ceil(nextStreet->length() / this->m_agents[agentId]->speed()));
-        nextStreet->addAgent(agentId);
-        m_agentNextStreetId.erase(agentId);
-      } else {
-        return false;
+      for (auto const nodeId : partition.enteredNodes) {
+        m_activeNodes.insert(nodeId);
       }
     }
+    m_activeStreets.retainIf(
+        [&](std::size_t index) { return streets[index]->nExitingAgents() > 0; });
+    m_activeNodes.retainIf([&](std::size_t nodeId) {
+      return this->m_nodeHasAgents(static_cast<Id>(nodeId));
+    });
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_enqueueAgent(Id agentId, Street* pStreet) {
+    auto const& agent{this->m_agents[agentId]};
+    auto const nLanes = pStreet->nLanes();
+    auto const streetIndex{this->m_graph.streetIndex(pStreet->id())};
+    m_activeStreets.insert(streetIndex);
+    m_queuedStreets.insert(streetIndex);
+    bool bArrived{false};
+    if (!agent->isRandom()) {
+      if (this->m_agentItinerary(agent)->destination() ==
+          pStreet->nodePair().second) {
+        agent->updateItinerary();
+      }
+      if (this->m_agentItinerary(agent)->destination() ==
+          pStreet->nodePair().second) {
+        bArrived = true;
+      }
+    }
+    auto const uniformIndex = [this, agentId](Size n) {
+      return this->m_uniformIndex(agentId, Draw::LANE, n);
+    };
+    if (bArrived) {
+      pStreet->enqueue(agentId, m_laneSelection.lane(nLanes, std::nullopt, uniformIndex));
+      return;
+    }
+    auto const nextStreetId =
+        this->m_nextStreetId(agentId, pStreet->nodePair().second, pStreet->id());
+    auto const& pNextStreet{this->m_graph.streetSet()[nextStreetId]};
+    agent->setNextStreetId(nextStreetId);
+    auto const deltaAngle{pNextStreet->deltaAngle(pStreet->angle())};
+    pStreet->enqueue(agentId, m_laneSelection.lane(nLanes, deltaAngle, uniformIndex));
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  bool RoadDynamics<delay_t, policies_t>::m_insertAgent(Id agentId) {
+    auto const& agent{this->m_agents[agentId]};
+    Id srcNodeId;
+    if (agent->srcNodeId().has_value()) {
+      srcNodeId = agent->srcNodeId().value();
+    } else {
+      srcNodeId = this->m_uniformIndex(
+          agentId, Draw::SOURCE_NODE, static_cast<Size>(this->m_graph.nNodes()));
+    }
+    if (this->m_isNodeFull(srcNodeId)) {
+      return false;
+    }
+    const auto& nextStreet{
+        this->m_graph.streetSet()[this->m_nextStreetId(agentId, srcNodeId)]};
+    if (nextStreet->isFull()) {
+      return false;
+    }
+    assert(srcNodeId == nextStreet->nodePair().first);
+    auto* const srcNode{this->m_graph.nodes()[srcNodeId]};
+    auto const srcKind{m_nodeKinds[srcNodeId]};
+    m_activeNodes.insert(srcNodeId);
+    if (srcKind == NodeKind::INTERSECTION || srcKind == NodeKind::TRAFFIC_LIGHT) {
+      auto& intersection = static_cast<Intersection&>(*srcNode);
+      intersection.addAgent(0., agentId);
+    } else if (srcKind == NodeKind::ROUNDABOUT) {
+      auto& roundabout = static_cast<Roundabout&>(*srcNode);
+      roundabout.enqueue(agentId);
+    }
+    agent->setNextStreetId(nextStreet->id());
     return true;
   }
 
-  template <typename delay_t>
+  template <typename delay_t, typename policies_t>
     requires(is_numeric_v<delay_t>)
-  void RoadDynamics<delay_t>::m_evolveAgents() {
-    std::uniform_int_distribution<Id> nodeDist{
-        0, static_cast<Id>(this->m_graph.nNodes() - 1)};
+  void RoadDynamics<delay_t, policies_t>::m_evolveAgents() {
+    if (m_bEventDriven) {
+      this->m_evolveAgentsEventDriven();
+      return;
+    }
     for (const auto& [agentId, agent] : this->m_agents) {
       if (agent->delay() > 0) {
         const auto& street{this->m_graph.streetSet()[agent->streetId().value()]};
@@ -393,90 +1272,213 @@ namespace dsm {
         }
         agent->decrementDelay();
         if (agent->delay() == 0) {
-          auto const nLanes = street->nLanes();
-          bool bArrived{false};
-          if (!agent->isRandom()) {
-            if (this->m_itineraries[agent->itineraryId()]->destination() ==
-                street->nodePair().second) {
-              agent->updateItinerary();
-            }
-            if (this->m_itineraries[agent->itineraryId()]->destination() ==
-                street->nodePair().second) {
-              bArrived = true;
-            }
-          }
-          if (bArrived) {
-            std::uniform_int_distribution<size_t> laneDist{
-                0, static_cast<size_t>(nLanes - 1)};
-            street->enqueue(agentId, laneDist(this->m_generator));
-          } else {
-            auto const nextStreetId =
-                this->m_nextStreetId(agentId, street->nodePair().second, street->id());
-            auto const& pNextStreet{this->m_graph.streetSet()[nextStreetId]};
-            m_agentNextStreetId.emplace(agentId, nextStreetId);
-            if (nLanes == 1) {
-              street->enqueue(agentId, 0);
-            } else {
-              auto const deltaAngle{pNextStreet->deltaAngle(street->angle())};
-              if (std::abs(deltaAngle) < std::numbers::pi) {
-                // Lanes are counted as 0 is the far right lane
-                if (deltaAngle < 0.) {                   // Right
-                  street->enqueue(agentId, 0);           // Always the first lane
-                } else if (deltaAngle > 0.) {            // Left
-                  street->enqueue(agentId, nLanes - 1);  // Always the last lane
-                } else {                                 // Straight
-                  std::uniform_int_distribution<size_t> laneDist{
-                      0, static_cast<size_t>(nLanes - 2)};
-                  street->enqueue(agentId, laneDist(this->m_generator));
-                }
-              } else {                                 // U turn
-                street->enqueue(agentId, nLanes - 1);  // Always the last lane
-              }
-            }
-          }
+          this->m_enqueueAgent(agentId, street.get());
         }
-      } else if (!agent->streetId().has_value() &&
-                 !m_agentNextStreetId.contains(agentId)) {
-        Id srcNodeId = agent->srcNodeId().has_value() ? agent->srcNodeId().value()
-                                                      : nodeDist(this->m_generator);
-        const auto& srcNode{this->m_graph.nodeSet()[srcNodeId]};
-        if (srcNode->isFull()) {
+      } else if (!agent->streetId().has_value() && !agent->nextStreetId().has_value()) {
+        if (!this->m_insertAgent(agentId)) {
           continue;
         }
-        const auto& nextStreet{
-            this->m_graph.streetSet()[this->m_nextStreetId(agentId, srcNode->id())]};
-        if (nextStreet->isFull()) {
-          continue;
-        }
-        assert(srcNode->id() == nextStreet->nodePair().first);
-        if (srcNode->isIntersection()) {
-          auto& intersection = dynamic_cast<Intersection&>(*srcNode);
-          intersection.addAgent(0., agentId);
-        } else if (srcNode->isRoundabout()) {
-          auto& roundabout = dynamic_cast<Roundabout&>(*srcNode);
-          roundabout.enqueue(agentId);
-        }
-        m_agentNextStreetId.emplace(agentId, nextStreet->id());
       } else if (agent->delay() == 0) {
-        agent->setSpeed(0.);
+        this->m_stopAgent(agentId);
       }
       agent->incrementTime();
     }
   }
 
-  template <typename delay_t>
+  template <typename delay_t, typename policies_t>
     requires(is_numeric_v<delay_t>)
-  void RoadDynamics<delay_t>::setErrorProbability(double errorProbability) {
-    if (errorProbability < 0. || errorProbability > 1.) {
-      throw std::invalid_argument(buildLog(std::format(
-          "The error probability ({}) must be between 0 and 1", errorProbability)));
+  void RoadDynamics<delay_t, policies_t>::m_evolveAgentsEventDriven() {
+    m_dueAgents.clear();
+    m_arrivals.pop(this->m_time, m_dueAgents);
+    // discard the arrivals of agents removed while travelling
+    std::erase_if(m_dueAgents, [this](Id agentId) {
+      if (!this->m_agents.contains(agentId)) {
+        return true;
+      }
+      auto const transitStart{m_transitStarts[this->m_agents.slot(agentId)]};
+      return transitStart == std::numeric_limits<Time>::max() ||
+             transitStart + this->m_agents[agentId]->delay() - 1 != this->m_time;
+    });
+    for (auto const agentId : m_idleAgents) {
+      auto const& agent{this->m_agents[agentId]};
+      if (!agent->streetId().has_value() && !agent->nextStreetId().has_value()) {
+        // waiting to enter the network
+        m_dueAgents.push_back(agentId);
+      } else {
+        this->m_stopAgent(agentId);
+        agent->incrementTime();
+      }
+    }
+    // arriving agents and agents entering the network draw random numbers, so they are
+    // processed in id order, as in the time-driven evolution
+    std::sort(m_dueAgents.begin(), m_dueAgents.end());
+    for (auto const agentId : m_dueAgents) {
+      auto const& agent{this->m_agents[agentId]};
+      if (agent->delay() == 0) {
+        if (this->m_insertAgent(agentId)) {
+          agent->incrementTime();
+        }
+        continue;
+      }
+      // catch up with the steps skipped while travelling
+      auto const& street{this->m_graph.streetSet()[agent->streetId().value()]};
+      auto const delay{agent->delay()};
+      if (delay > 1) {
+        agent->incrementDistance(agent->speed() * (delay - 1));
+      }
+      double distance{std::fmod(street->length(), agent->speed())};
+      if (distance < std::numeric_limits<double>::epsilon()) {
+        agent->incrementDistance();
+      } else {
+        agent->incrementDistance(distance);
+      }
+      agent->decrementDelay(delay);
+      agent->incrementTime(delay);
+      m_transitStarts[this->m_agents.slot(agentId)] = std::numeric_limits<Time>::max();
+      this->m_enqueueAgent(agentId, street.get());
+    }
+    // the arrived agents are now waiting at the end of their street
+    for (auto const agentId : m_dueAgents) {
+      this->m_addIdleAgent(agentId);
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_agentDeparted(Id agentId) {
+    if (!m_bEventDriven) {
+      return;
+    }
+    auto const& agent{this->m_agents[agentId]};
+    this->m_removeIdleAgent(agentId);
+    auto const slot{this->m_agents.slot(agentId)};
+    if (slot >= m_transitStarts.size()) {
+      m_transitStarts.resize(this->m_agents.capacity(), std::numeric_limits<Time>::max());
+    }
+    // the delay is decremented for the first time during the current step
+    m_transitStarts[slot] = this->m_time;
+    m_arrivals.schedule(agentId, this->m_time + agent->delay() - 1);
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_agentAdded(Id agentId) {
+    if (m_bEventDriven) {
+      this->m_addIdleAgent(agentId);
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_agentRemoved(Id agentId) {
+    if (!m_bEventDriven) {
+      return;
+    }
+    this->m_removeIdleAgent(agentId);
+    if (auto const slot{this->m_agents.slot(agentId)}; slot < m_transitStarts.size()) {
+      // the slot may be reused, and a scheduled arrival is discarded when it comes due
+      m_transitStarts[slot] = std::numeric_limits<Time>::max();
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_addIdleAgent(Id agentId) {
+    auto const slot{this->m_agents.slot(agentId)};
+    if (slot >= m_idleIndices.size()) {
+      m_idleIndices.resize(this->m_agents.capacity(), std::numeric_limits<Size>::max());
     }
-    m_errorProbability = errorProbability;
+    if (m_idleIndices[slot] != std::numeric_limits<Size>::max()) {
+      return;
+    }
+    m_idleIndices[slot] = static_cast<Size>(m_idleAgents.size());
+    m_idleAgents.push_back(agentId);
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::m_removeIdleAgent(Id agentId) {
+    auto const slot{this->m_agents.slot(agentId)};
+    if (slot >= m_idleIndices.size() ||
+        m_idleIndices[slot] == std::numeric_limits<Size>::max()) {
+      return;
+    }
+    auto const index{m_idleIndices[slot]};
+    m_idleIndices[this->m_agents.slot(m_idleAgents.back())] = index;
+    m_idleAgents[index] = m_idleAgents.back();
+    m_idleAgents.pop_back();
+    m_idleIndices[slot] = std::numeric_limits<Size>::max();
   }
 
-  template <typename delay_t>
+  template <typename delay_t, typename policies_t>
     requires(is_numeric_v<delay_t>)
-  void RoadDynamics<delay_t>::setPassageProbability(double passageProbability) {
+  void RoadDynamics<delay_t, policies_t>::setTwoPhase(bool twoPhase) {
+    if (twoPhase && !m_bTwoPhase) {
+      // no lane is parked in two-phase mode
+      this->m_wakeAllLanes();
+    }
+    m_bTwoPhase = twoPhase;
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::setPartitions(Size nPartitions) {
+    if (nPartitions == 0) {
+      throw std::invalid_argument(buildLog("The number of partitions must be positive."));
+    }
+    m_nPartitions = nPartitions;
+    m_partitions.clear();
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::setEventDriven(bool eventDriven) {
+    if (eventDriven == m_bEventDriven) {
+      return;
+    }
+    if (!eventDriven) {
+      // bring the travelling agents up to date
+      for (const auto& [agentId, agent] : this->m_agents) {
+        auto const slot{this->m_agents.slot(agentId)};
+        if (slot >= m_transitStarts.size() ||
+            m_transitStarts[slot] == std::numeric_limits<Time>::max()) {
+          continue;
+        }
+        auto const elapsed{this->m_time - m_transitStarts[slot]};
+        agent->incrementDistance(agent->speed() * elapsed);
+        agent->decrementDelay(static_cast<delay_t>(elapsed));
+        agent->incrementTime(static_cast<unsigned int>(elapsed));
+      }
+    }
+    m_arrivals.clear();
+    m_transitStarts.clear();
+    m_idleAgents.clear();
+    m_idleIndices.clear();
+    m_bEventDriven = eventDriven;
+    if (eventDriven) {
+      for (const auto& [agentId, agent] : this->m_agents) {
+        if (agent->delay() > 0) {
+          this->m_agentDeparted(agentId);
+        } else {
+          this->m_addIdleAgent(agentId);
+        }
+      }
+    }
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::setAgentSpeed(Size agentId) {
+    auto* const pAgent{this->m_agents[agentId]};
+    auto const& street{*this->m_graph.streetSet().at(pAgent->streetId().value())};
+    pAgent->setSpeed(this->speed(street, [this, agentId]() {
+      return this->m_normal(agentId, Draw::SPEED, 0., 1.);
+    }));
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  void RoadDynamics<delay_t, policies_t>::setPassageProbability(double passageProbability) {
     if (passageProbability < 0. || passageProbability > 1.) {
       throw std::invalid_argument(buildLog(std::format(
           "The passage probability ({}) must be between 0 and 1", passageProbability)));
@@ -484,9 +1486,9 @@ namespace dsm {
     m_passageProbability = passageProbability;
   }
 
-  template <typename delay_t>
+  template <typename delay_t, typename policies_t>
     requires(is_numeric_v<delay_t>)
-  void RoadDynamics<delay_t>::addAgentsUniformly(Size nAgents,
+  void RoadDynamics<delay_t, policies_t>::addAgentsUniformly(Size nAgents,
                                                  std::optional<Id> optItineraryId) {
     if (this->m_itineraries.empty()) {
       // TODO: make this possible for random agents
@@ -508,10 +1510,7 @@ namespace dsm {
         std::advance(itineraryIt, itineraryDist(this->m_generator));
         itineraryId = itineraryIt->first;
       }
-      Id agentId{0};
-      if (!this->m_agents.empty()) {
-        agentId = this->m_agents.rbegin()->first + 1;
-      }
+      Id agentId{this->m_agents.nextId()};
       Id streetId{0};
       do {
         auto streetIt = this->m_graph.streetSet().begin();
@@ -526,17 +1525,18 @@ namespace dsm {
       this->setAgentSpeed(agentId);
       this->m_agents[agentId]->incrementDelay(
           std::ceil(street->length() / this->m_agents[agentId]->speed()));
-      street->addAgent(agentId);
+      this->m_agentDeparted(agentId);
+      street->addAgent(agentId, this->m_agents[agentId]->speed());
       ++agentId;
     }
   }
 
-  template <typename delay_t>
+  template <typename delay_t, typename policies_t>
     requires(is_numeric_v<delay_t>)
   template <typename TContainer>
     requires(std::is_same_v<TContainer, std::unordered_map<Id, double>> ||
              std::is_same_v<TContainer, std::map<Id, double>>)
-  void RoadDynamics<delay_t>::addAgentsRandomly(Size nAgents,
+  void RoadDynamics<delay_t, policies_t>::addAgentsRandomly(Size nAgents,
                                                 const TContainer& src_weights,
                                                 const TContainer& dst_weights) {
     if (src_weights.size() == 1 && dst_weights.size() == 1 &&
@@ -569,10 +1569,7 @@ namespace dsm {
         })};
     std::uniform_real_distribution<double> srcUniformDist{0., srcSum};
     std::uniform_real_distribution<double> dstUniformDist{0., dstSum};
-    Id agentId{0};
-    if (!this->m_agents.empty()) {
-      agentId = this->m_agents.rbegin()->first + 1;
-    }
+    Id agentId{this->m_agents.nextId()};
     while (nAgents > 0) {
       Id srcId{0}, dstId{0};
       if (dst_weights.size() == 1) {
@@ -621,31 +1618,48 @@ namespace dsm {
     }
   }
 
-  template <typename delay_t>
+  template <typename delay_t, typename policies_t>
     requires(is_numeric_v<delay_t>)
-  void RoadDynamics<delay_t>::evolve(bool reinsert_agents) {
+  void RoadDynamics<delay_t, policies_t>::evolve(bool reinsert_agents) {
     // move the first agent of each street queue, if possible, putting it in the next node
     bool const bUpdateData =
         m_dataUpdatePeriod.has_value() && this->m_time % m_dataUpdatePeriod.value() == 0;
-    for (const auto& [streetId, pStreet] : this->m_graph.streetSet()) {
-      if (bUpdateData) {
-        m_streetTails[streetId] += pStreet->nExitingAgents();
-      }
-      for (auto i = 0; i < pStreet->transportCapacity(); ++i) {
-        this->m_evolveStreet(pStreet, reinsert_agents);
-      }
+    auto const& streets{this->m_graph.streets()};
+    if (bUpdateData) {
+      m_queuedStreets.retainIf([&](std::size_t index) {
+        auto* const pStreet{streets[index]};
+        m_streetTails[index] += pStreet->nExitingAgents();
+        return pStreet->nExitingAgents() > 0;
+      });
+      m_dataUpdate(*this);
     }
-    // Move transport capacity agents from each node
-    for (const auto& [nodeId, pNode] : this->m_graph.nodeSet()) {
-      for (auto i = 0; i < pNode->transportCapacity(); ++i) {
-        if (!this->m_evolveNode(pNode)) {
-          break;
+    if (m_bTwoPhase) {
+      this->m_evolveTwoPhase(reinsert_agents);
+    } else {
+      // wake up the lanes whose light turns green
+      m_wokenLanes.clear();
+      m_greenWakes.pop(this->m_time, m_wokenLanes);
+      this->m_wakeLanes(m_wokenLanes);
+      // only the streets with non-empty, unblocked queues are visited, in dense order
+      m_activeStreets.retainIf([&](std::size_t index) {
+        auto* const pStreet{streets[index]};
+        auto const nPasses{std::max<int16_t>(pStreet->transportCapacity(), 0)};
+        this->m_evolveStreet(
+            static_cast<Size>(index), static_cast<Size>(nPasses), reinsert_agents);
+        return this->m_hasRunnableLane(index);
+      });
+      // Move transport capacity agents from each node holding agents
+      auto const& nodes{this->m_graph.nodes()};
+      m_activeNodes.retainIf([&](std::size_t nodeId) {
+        auto* const pNode{nodes[nodeId]};
+        if (this->m_evolveNode(pNode, pNode->transportCapacity()) > 0) {
+          this->m_wakeLanes(m_nodeWaiters[nodeId]);
         }
-      }
-      if (pNode->isTrafficLight()) {
-        auto& tl = dynamic_cast<TrafficLight&>(*pNode);
-        ++tl;  // Increment the counter
-      }
+        return this->m_nodeHasAgents(nodeId);
+      });
+    }
+    for (auto* const pTrafficLight : m_trafficLights) {
+      ++(*pTrafficLight);  // Increment the counter
     }
     // cycle over agents and update their times
     this->m_evolveAgents();
@@ -653,9 +1667,9 @@ namespace dsm {
     ++this->m_time;
   }
 
-  template <typename delay_t>
+  template <typename delay_t, typename policies_t>
     requires(is_numeric_v<delay_t>)
-  void RoadDynamics<delay_t>::optimizeTrafficLights(
+  void RoadDynamics<delay_t, policies_t>::optimizeTrafficLights(
       double const threshold,
       double const densityTolerance,
       TrafficLightOptimization const optimizationType) {
@@ -680,14 +1694,14 @@ namespace dsm {
       const auto& streetPriorities = tl.streetPriorities();
       Size greenSum{0}, greenQueue{0};
       Size redSum{0}, redQueue{0};
-      for (const auto& [streetId, _] : this->m_graph.adjMatrix().getCol(nodeId, true)) {
+      for (const auto streetId : this->m_graph.inStreets(nodeId)) {
         if (streetPriorities.contains(streetId)) {
-          greenSum += m_streetTails[streetId];
+          greenSum += m_streetTails[this->m_graph.streetIndex(streetId)];
           for (auto const& queue : this->m_graph.streetSet()[streetId]->exitQueues()) {
             greenQueue += queue.size();
           }
         } else {
-          redSum += m_streetTails[streetId];
+          redSum += m_streetTails[this->m_graph.streetIndex(streetId)];
           for (auto const& queue : this->m_graph.streetSet()[streetId]->exitQueues()) {
             redQueue += queue.size();
           }
@@ -729,12 +1743,12 @@ namespace dsm {
         double meanDensity_streets{0.};
         {
           // Store the ids of outgoing streets
-          const auto& row{this->m_graph.adjMatrix().getRow(nodeId, true)};
-          for (const auto& [streetId, _] : row) {
+          const auto outStreets{this->m_graph.outStreets(nodeId)};
+          for (const auto streetId : outStreets) {
             meanDensity_streets += this->m_graph.streetSet()[streetId]->density();
           }
           // Take the mean density of the outgoing streets
-          const auto nStreets = row.size();
+          const auto nStreets = outStreets.size();
           if (nStreets > 1) {
             meanDensity_streets /= nStreets;
           }
@@ -767,16 +1781,16 @@ namespace dsm {
         }
       }
     }
+    // the cycles may have changed: re-examine all the blocked lanes
+    this->m_wakeAllLanes();
     // Cleaning variables
-    for (auto& [id, element] : m_streetTails) {
-      element = 0;
-    }
+    std::fill(m_streetTails.begin(), m_streetTails.end(), 0);
     m_previousOptimizationTime = this->m_time;
   }
 
-  template <typename delay_t>
+  template <typename delay_t, typename policies_t>
     requires(is_numeric_v<delay_t>)
-  Measurement<double> RoadDynamics<delay_t>::meanTravelTime(bool clearData) {
+  Measurement<double> RoadDynamics<delay_t, policies_t>::meanTravelTime(bool clearData) {
     std::vector<double> travelTimes;
     if (!m_travelTimes.empty()) {
       if (clearData) {
@@ -791,27 +1805,96 @@ namespace dsm {
     return Measurement<double>(travelTimes);
   }
 
-  template <typename delay_t>
+  template <typename delay_t, typename policies_t>
     requires(is_numeric_v<delay_t>)
-  std::unordered_map<Id, std::array<double, 4>> RoadDynamics<delay_t>::turnProbabilities(
+  std::unordered_map<Id, std::array<double, 4>> RoadDynamics<delay_t, policies_t>::turnProbabilities(
       bool reset) {
     std::unordered_map<Id, std::array<double, 4>> res;
-    for (auto& [streetId, counts] : m_turnCounts) {
+    auto const& streets{this->m_graph.streets()};
+    for (Size index{0}; index < streets.size(); ++index) {
+      auto const& counts{m_turnCounts[index]};
       std::array<double, 4> probabilities{0., 0., 0., 0.};
       const auto sum{std::accumulate(counts.cbegin(), counts.cend(), 0.)};
       if (sum != 0) {
-        for (auto i{0}; i < counts.size(); ++i) {
+        for (std::size_t i{0}; i < counts.size(); ++i) {
           probabilities[i] = counts[i] / sum;
         }
       }
-      res.emplace(streetId, probabilities);
+      res.emplace(streets[index]->id(), probabilities);
     }
     if (reset) {
-      for (auto& [streetId, counts] : m_turnCounts) {
+      for (auto& counts : m_turnCounts) {
         std::fill(counts.begin(), counts.end(), 0);
       }
     }
     return res;
   }
 
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  std::unordered_map<Id, std::array<unsigned long long, 4>>
+  RoadDynamics<delay_t, policies_t>::turnCounts() const {
+    std::unordered_map<Id, std::array<unsigned long long, 4>> turnCounts;
+    auto const& streets{this->m_graph.streets()};
+    for (Size index{0}; index < streets.size(); ++index) {
+      turnCounts.emplace(streets[index]->id(), m_turnCounts[index]);
+    }
+    return turnCounts;
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  double RoadDynamics<delay_t, policies_t>::streetMeanSpeed(Id streetId) const {
+    const auto& street{this->m_graph.streetSet().at(streetId)};
+    if (street->nAgents() == 0) {
+      return street->maxSpeed();
+    }
+    Size n{street->nAgents()};
+    double meanSpeed{0.};
+    if (street->nExitingAgents() == 0) {
+      meanSpeed = this->travellingSpeedSum(*street);
+    } else {
+      meanSpeed = street->speedSum();
+    }
+    const auto& node = this->m_graph.nodeSet().at(street->nodePair().second);
+    if (node->isIntersection()) {
+      auto& intersection = dynamic_cast<Intersection&>(*node);
+      for (const auto& [angle, agentId] : intersection.agents()) {
+        const auto& agent{this->m_agents.at(agentId)};
+        if (agent->streetId().has_value() && agent->streetId().value() == streetId) {
+          meanSpeed += agent->speed();
+          ++n;
+        }
+      }
+    } else if (node->isRoundabout()) {
+      auto& roundabout = dynamic_cast<Roundabout&>(*node);
+      for (const auto& agentId : roundabout.agents()) {
+        const auto& agent{this->m_agents.at(agentId)};
+        if (agent->streetId().has_value() && agent->streetId().value() == streetId) {
+          meanSpeed += agent->speed();
+          ++n;
+        }
+      }
+    }
+    return meanSpeed / n;
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  Measurement<double> RoadDynamics<delay_t, policies_t>::streetMeanSpeed() const {
+    if (this->m_agents.size() == 0) {
+      return Measurement(0., 0.);
+    }
+    return Dynamics<Agent<delay_t>>::streetMeanSpeed();
+  }
+
+  template <typename delay_t, typename policies_t>
+    requires(is_numeric_v<delay_t>)
+  Measurement<double> RoadDynamics<delay_t, policies_t>::streetMeanSpeed(double threshold,
+                                                                        bool above) const {
+    if (this->m_agents.size() == 0) {
+      return Measurement(0., 0.);
+    }
+    return Dynamics<Agent<delay_t>>::streetMeanSpeed(threshold, above);
+  }
 };  // namespace dsm
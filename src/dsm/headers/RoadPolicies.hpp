@@ -0,0 +1,210 @@
+/// @file       /src/dsm/headers/RoadPolicies.hpp
+/// @brief      Defines the policies which specialize the RoadDynamics class.
+///
+/// @details    This file contains the definition of the policies of the RoadDynamics class:
+///             the speed model, the lane selection, the route choice, the data update
+///             hook and the intersection priorities. The policies are chosen at compile
+///             time, so the calls made in the evolution of the dynamics are resolved
+///             statically and can be inlined. The speed model, the route choice and the
+///             intersection priorities are base classes of the dynamics, so their public
+///             members, e.g. the setters of their parameters, are members of the dynamics
+///             too.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <numbers>
+#include <optional>
+#include <stdexcept>
+
+#include "Street.hpp"
+#include "../utility/Logger.hpp"
+#include "../utility/Typedef.hpp"
+
+namespace dsm {
+  /// @brief The FirstOrderSpeed class is a speed model linear in the street's density
+  /// @details The speed of an agent entering a street is
+  /// \f$ v = v_{\text{max}} \left(1 - \alpha \rho \right) \f$, where \f$ \rho \f$ is the
+  /// normalized density of the street. A gaussian fluctuation, whose standard deviation is
+  /// proportional to the speed, can be added.
+  class FirstOrderSpeed {
+    double m_alpha;
+    double m_speedFluctuationSTD;
+
+  public:
+    /// @brief Construct a new FirstOrderSpeed object
+    /// @param alpha The minimum speed rateo
+    /// @throw std::invalid_argument If alpha is not between 0 and 1
+    explicit FirstOrderSpeed(double alpha = 0.)
+        : m_alpha{alpha}, m_speedFluctuationSTD{0.} {
+      if (alpha < 0. || alpha > 1.) {
+        throw std::invalid_argument(buildLog(std::format(
+            "The minimum speed rateo must be between 0 and 1, but it is {}", alpha)));
+      }
+    }
+
+    /// @brief Set the standard deviation of the speed fluctuation
+    /// @param speedFluctuationSTD The standard deviation of the speed fluctuation
+    /// @throw std::invalid_argument, If the standard deviation is negative
+    void setSpeedFluctuationSTD(double speedFluctuationSTD) {
+      if (speedFluctuationSTD < 0.) {
+        throw std::invalid_argument(
+            buildLog("The speed fluctuation standard deviation must be positive."));
+      }
+      m_speedFluctuationSTD = speedFluctuationSTD;
+    }
+
+    /// @brief Get the speed of an agent entering a street
+    /// @tparam F The type of the source of standard normal numbers
+    /// @param street The street
+    /// @param standardNormal A callable drawing a standard normal number, only called if
+    /// the speed fluctuates
+    /// @return double The speed
+    template <typename F>
+    double speed(const Street& street, F&& standardNormal) const {
+      double speed{street.maxSpeed() * (1. - m_alpha * street.density(true))};
+      if (m_speedFluctuationSTD > 0.) {
+        speed += speed * m_speedFluctuationSTD * standardNormal();
+      }
+      return speed < 0. ? this->minSpeed(street) : speed;
+    }
+    /// @brief Get the minimum speed along a street
+    /// @param street The street
+    /// @return double The speed in a full street, without fluctuations
+    double minSpeed(const Street& street) const {
+      return street.maxSpeed() * (1. - m_alpha);
+    }
+    /// @brief Get the mean speed of the agents travelling along a street
+    /// @param street The street, with no agents waiting at its end
+    /// @return double The sum of the speeds the agents had when they entered the street
+    /// @details The agents have entered the street one at a time, so the sum is
+    /// \f$ v_{\text{max}} n \left(1 - \frac{\alpha}{2 c} \left( n - 1\right) \right) \f$,
+    /// where \f$ n \f$ is the number of agents and \f$ c \f$ the capacity of the street.
+    double travellingSpeedSum(const Street& street) const {
+      auto const n{static_cast<double>(street.nAgents())};
+      double alpha{m_alpha / street.capacity()};
+      return street.maxSpeed() * n * (1. - 0.5 * alpha * (n - 1.));
+    }
+  };
+
+  /// @brief The TurnLaneSelection class chooses the lane by the direction of the next turn
+  /// @details Lanes are counted from the far right one. Agents turning right take the
+  /// first lane, agents turning left or making a U-turn the last one, and agents going
+  /// straight any lane but the last one. Agents at their destination take any lane.
+  struct TurnLaneSelection {
+    /// @brief Choose the lane of an agent reaching the end of a street
+    /// @tparam F The type of the source of uniform integers
+    /// @param nLanes The number of lanes of the street
+    /// @param deltaAngle The angle of the turn towards the next street, or std::nullopt if
+    /// the agent has reached its destination
+    /// @param uniformIndex A callable which takes n and draws an integer in [0, n)
+    /// @return std::size_t The index of the lane
+    template <typename F>
+    std::size_t lane(int16_t nLanes,
+                     std::optional<double> deltaAngle,
+                     F&& uniformIndex) const {
+      if (!deltaAngle.has_value()) {
+        return uniformIndex(static_cast<Size>(nLanes));
+      }
+      if (nLanes == 1) {
+        return 0;
+      }
+      if (std::abs(deltaAngle.value()) >= std::numbers::pi || deltaAngle.value() > 0.) {
+        return nLanes - 1;  // U-turn or left
+      }
+      if (deltaAngle.value() < 0.) {
+        return 0;  // right
+      }
+      return uniformIndex(static_cast<Size>(nLanes - 1));  // straight
+    }
+  };
+
+  /// @brief The ShortestPathRouteChoice class makes agents follow their itinerary, with
+  /// a probability of taking a random street instead
+  class ShortestPathRouteChoice {
+    double m_errorProbability{0.};
+
+  public:
+    /// @brief Set the error probability
+    /// @param errorProbability The error probability
+    /// @throw std::invalid_argument If the error probability is not between 0 and 1
+    void setErrorProbability(double errorProbability) {
+      if (errorProbability < 0. || errorProbability > 1.) {
+        throw std::invalid_argument(buildLog(std::format(
+            "The error probability ({}) must be between 0 and 1", errorProbability)));
+      }
+      m_errorProbability = errorProbability;
+    }
+    /// @brief Check if an agent follows its itinerary at a node
+    /// @param draw A number uniformly distributed in [0, 1)
+    /// @return bool True if the agent follows its itinerary, false if it takes a random
+    /// street
+    bool followsItinerary(double draw) const { return draw > m_errorProbability; }
+  };
+
+  /// @brief The StrictRouteChoice class makes agents always follow their itinerary
+  struct StrictRouteChoice {
+    /// @brief Check if an agent follows its itinerary at a node
+    /// @return bool Always true
+    static constexpr bool followsItinerary(double) { return true; }
+  };
+
+  /// @brief The ConfigurablePriorities class lets the intersection priorities be switched
+  /// on and off at run time
+  class ConfigurablePriorities {
+    bool m_forcePriorities{false};
+
+  public:
+    /// @brief Set the force priorities flag
+    /// @param forcePriorities The flag
+    /// @details If true, if an agent cannot move to the next street, the whole node is skipped
+    void setForcePriorities(bool forcePriorities) { m_forcePriorities = forcePriorities; }
+    /// @brief Check if the intersection priorities are enforced
+    /// @return bool True if an agent which cannot move blocks the agents behind it
+    bool forcePriorities() const { return m_forcePriorities; }
+  };
+
+  /// @brief The ForcedPriorities class always enforces the intersection priorities
+  struct ForcedPriorities {
+    /// @brief Check if the intersection priorities are enforced
+    /// @return bool Always true
+    static constexpr bool forcePriorities() { return true; }
+  };
+
+  /// @brief The FreePriorities class never enforces the intersection priorities, so an
+  /// agent which cannot move is overtaken by the ones behind it
+  struct FreePriorities {
+    /// @brief Check if the intersection priorities are enforced
+    /// @return bool Always false
+    static constexpr bool forcePriorities() { return false; }
+  };
+
+  /// @brief The NoDataUpdate class is a data update hook which does nothing
+  struct NoDataUpdate {
+    /// @brief Called by the dynamics at each data update, after the street tails are updated
+    template <typename dynamics_t>
+    void operator()(const dynamics_t&) const {}
+  };
+
+  /// @brief The RoadPolicies struct gathers the policies of a RoadDynamics
+  /// @tparam speed_model_t The speed model, providing speed, minSpeed and travellingSpeedSum
+  /// @tparam lane_selection_t The lane selection, providing lane
+  /// @tparam route_choice_t The route choice, providing followsItinerary
+  /// @tparam data_update_t The hook called at each data update
+  /// @tparam intersection_priorities_t The intersection priorities, providing forcePriorities
+  template <typename speed_model_t = FirstOrderSpeed,
+            typename lane_selection_t = TurnLaneSelection,
+            typename route_choice_t = ShortestPathRouteChoice,
+            typename data_update_t = NoDataUpdate,
+            typename intersection_priorities_t = ConfigurablePriorities>
+  struct RoadPolicies {
+    using speed_model = speed_model_t;
+    using lane_selection = lane_selection_t;
+    using route_choice = route_choice_t;
+    using data_update = data_update_t;
+    using intersection_priorities = intersection_priorities_t;
+  };
+};  // namespace dsm
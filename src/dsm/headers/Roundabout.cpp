@@ -11,15 +11,18 @@ namespace dsm {
     this->setCapacity(node.capacity());
   }
 
+  void Roundabout::setCapacity(Size capacity) {
+    Node::setCapacity(capacity);
+    m_agents.reserve(capacity);
+  }
+
   void Roundabout::enqueue(Id agentId) {
     if (isFull()) {
       throw std::runtime_error(buildLog("Roundabout is full."));
     }
-    for (const auto id : m_agents) {
-      if (id == agentId) {
-        throw std::runtime_error(buildLog(
-            std::format("Agent with id {} is already on the roundabout.", agentId)));
-      }
+    if (m_agents.contains(agentId)) {
+      throw std::runtime_error(buildLog(
+          std::format("Agent with id {} is already on the roundabout.", agentId)));
     }
     m_agents.push(agentId);
   }
@@ -8,7 +8,7 @@
 #pragma once
 
 #include "Node.hpp"
-#include "../utility/queue.hpp"
+#include "../utility/RingBuffer.hpp"
 
 namespace dsm {
   /// @brief The Roundabout class represents a roundabout node in the network.
@@ -16,22 +16,29 @@ namespace dsm {
   /// @tparam Size The type of the node's capacity
   class Roundabout : public Node {
   protected:
-    dsm::queue<Id> m_agents;
+    RingBuffer<Id> m_agents;
 
   public:
     /// @brief Construct a new Roundabout object
     /// @param id The node's id
-    explicit Roundabout(Id id) : Node{id} {};
+    explicit Roundabout(Id id) : Node{id} { m_agents.reserve(m_capacity); };
     /// @brief Construct a new Roundabout object
     /// @param id The node's id
     /// @param coords A std::pair containing the node's coordinates
-    Roundabout(Id id, std::pair<double, double> coords) : Node{id, coords} {};
+    Roundabout(Id id, std::pair<double, double> coords) : Node{id, coords} {
+      m_agents.reserve(m_capacity);
+    };
     /// @brief Construct a new Roundabout object
     /// @param node An Intersection object
     Roundabout(const Node& node);
 
     virtual ~Roundabout() = default;
 
+    /// @brief Set the node's capacity
+    /// @param capacity The node's capacity
+    /// @details The queue is preallocated to hold the whole capacity.
+    void setCapacity(Size capacity) override;
+
     /// @brief Put an agent in the node
     /// @param agentId The agent's id
     /// @throws std::runtime_error if the node is full
@@ -40,8 +47,8 @@ namespace dsm {
     /// @return Id The agent's id
     Id dequeue();
     /// @brief Get the node's queue
-    /// @return dsm::queue<Id> The node's queue
-    const dsm::queue<Id>& agents() const { return m_agents; }
+    /// @return RingBuffer<Id> The node's queue
+    const RingBuffer<Id>& agents() const { return m_agents; }
     /// @brief Returns the node's density
     /// @return double The node's density
     double density() const override {
@@ -49,7 +56,7 @@ namespace dsm {
     }
     /// @brief Returns true if the node is full
     /// @return bool True if the node is full
-    bool isFull() const override { return m_agents.size() == this->m_capacity; }
+    bool isFull() const final { return m_agents.size() == this->m_capacity; }
     /// @brief Returns true if the node is a roundabout
     /// @return bool True if the node is a roundabout
     bool isRoundabout() const noexcept override { return true; }
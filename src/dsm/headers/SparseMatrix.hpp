@@ -25,9 +25,11 @@ namespace dsm {
   /// @brief The SparseMatrix class represents a sparse matrix.
   /// @tparam Id The type of the matrix's index. It must be an unsigned integral type.
   /// @tparam T The type of the matrix's value.
+  /// @details The elements are stored by their linear index, i.e. i * cols + j, which is a
+  /// 64-bit integer, so that the matrix dimensions can span the whole range of Id.
   template <typename T>
   class SparseMatrix {
-    std::unordered_map<Id, T> _matrix;
+    std::unordered_map<uint64_t, T> _matrix;
     Id _rows, _cols;
     T _defaultReturn;
 
@@ -56,7 +58,7 @@ namespace dsm {
     /// @param i index
     /// @param value value to insert
     /// @throw std::out_of_range if the index is out of range
-    void insert(Id i, T value);
+    void insert(uint64_t i, T value);
 
     /// @brief insert a value in the matrix. If the element already exist, it
     /// overwrites it
@@ -71,7 +73,7 @@ namespace dsm {
     /// @param index index in vectorial form
     /// @param value value to insert
     /// @throw std::out_of_range if the index is out of range
-    void insert_or_assign(Id index, T value);
+    void insert_or_assign(uint64_t index, T value);
 
     /// @brief insert a value in the matrix and expand the matrix if necessary.
     /// @param i row index
@@ -90,7 +92,7 @@ namespace dsm {
     /// @param index index in vectorial form
     /// @throw std::out_of_range if the index is out of range
     /// @throw std::runtime_error if the element is not found
-    void erase(Id index);
+    void erase(uint64_t index);
 
     /// @brief remove a row from the matrix
     /// @param index row index
@@ -122,7 +124,7 @@ namespace dsm {
     /// @param index index in vectorial form
     /// @return true if the element is non zero
     /// @throw std::out_of_range if the index is out of range
-    bool contains(Id const index) const;
+    bool contains(uint64_t const index) const;
 
     /// @brief get the input degree of all nodes
     /// @return a SparseMatrix vector with the input degree of all nodes
@@ -179,7 +181,7 @@ namespace dsm {
 
     /// @brief get the maximum number of elements in the matrix
     /// @return maximum number of elements
-    Id max_size() const { return _rows * _cols; }
+    uint64_t max_size() const { return static_cast<uint64_t>(_rows) * _cols; }
 
     /// @brief symmetrize the matrix
     void symmetrize();
@@ -192,13 +194,13 @@ namespace dsm {
 
     /// @brief return the begin iterator of the matrix
     /// @return the begin iterator
-    typename std::unordered_map<Id, T>::const_iterator begin() const {
+    typename std::unordered_map<uint64_t, T>::const_iterator begin() const {
       return _matrix.begin();
     }
 
     /// @brief return the end iterator of the matrix
     /// @return the end iterator
-    typename std::unordered_map<Id, T>::const_iterator end() const {
+    typename std::unordered_map<uint64_t, T>::const_iterator end() const {
       return _matrix.end();
     }
 
@@ -220,13 +222,13 @@ namespace dsm {
     /// @param index index in vectorial form
     /// @return the element
     /// @throw std::out_of_range if the index is out of range
-    const T& operator()(Id index) const;
+    const T& operator()(uint64_t index) const;
 
     /// @brief access an element of the matrix
     /// @param index index in vectorial form
     /// @return the element
     /// @throw std::out_of_range if the index is out of range
-    T& operator()(Id index);
+    T& operator()(uint64_t index);
 
     /// @brief sum of two matrices
     /// @param other the other matrix
@@ -238,7 +240,7 @@ namespace dsm {
         throw std::runtime_error(buildLog("Dimensions do not match"));
       }
       auto result = SparseMatrix<T>(this->_rows, this->_cols);
-      std::unordered_map<Id, bool> unique;
+      std::unordered_map<uint64_t, bool> unique;
       for (auto& it : this->_matrix) {
         unique.insert_or_assign(it.first, true);
       }
@@ -263,7 +265,7 @@ namespace dsm {
         throw std::runtime_error(buildLog("Dimensions do not match"));
       }
       auto result = SparseMatrix(this->_rows, this->_cols);
-      std::unordered_map<Id, bool> unique;
+      std::unordered_map<uint64_t, bool> unique;
       for (auto& it : this->_matrix) {
         unique.insert_or_assign(it.first, true);
       }
@@ -299,45 +301,45 @@ namespace dsm {
 
   template <typename T>
   SparseMatrix<T>::SparseMatrix()
-      : _matrix{std::unordered_map<Id, T>()}, _rows{}, _cols{}, _defaultReturn{0} {}
+      : _matrix{std::unordered_map<uint64_t, T>()}, _rows{}, _cols{}, _defaultReturn{0} {}
 
   template <typename T>
   SparseMatrix<T>::SparseMatrix(Id rows, Id cols)
-      : _matrix{std::unordered_map<Id, T>()},
+      : _matrix{std::unordered_map<uint64_t, T>()},
         _rows{rows},
         _cols{cols},
         _defaultReturn{0} {}
 
   template <typename T>
   SparseMatrix<T>::SparseMatrix(Id index)
-      : _matrix{std::unordered_map<Id, T>()}, _rows{index}, _cols{1}, _defaultReturn{0} {}
+      : _matrix{std::unordered_map<uint64_t, T>()}, _rows{index}, _cols{1}, _defaultReturn{0} {}
 
   template <typename T>
   void SparseMatrix<T>::insert(Id i, Id j, T value) {
-    const auto index = i * _cols + j;
+    const auto index = static_cast<uint64_t>(i) * _cols + j;
     this->insert(index, value);
   }
 
   template <typename T>
-  void SparseMatrix<T>::insert(Id i, T value) {
-    if (i > _rows * _cols - 1) {
+  void SparseMatrix<T>::insert(uint64_t i, T value) {
+    if (i > max_size() - 1) {
       throw std::out_of_range(
-          buildLog(std::format("Id {} out of range 0-{}", i, _rows * _cols - 1)));
+          buildLog(std::format("Id {} out of range 0-{}", i, max_size() - 1)));
     }
     _matrix.emplace(std::make_pair(i, value));
   }
 
   template <typename T>
   void SparseMatrix<T>::insert_or_assign(Id i, Id j, T value) {
-    const auto index = i * _cols + j;
+    const auto index = static_cast<uint64_t>(i) * _cols + j;
     this->insert_or_assign(index, value);
   }
 
   template <typename T>
-  void SparseMatrix<T>::insert_or_assign(Id index, T value) {
-    if (index > _rows * _cols - 1) {
+  void SparseMatrix<T>::insert_or_assign(uint64_t index, T value) {
+    if (index > max_size() - 1) {
       throw std::out_of_range(
-          buildLog(std::format("Id {} out of range 0-{}", index, _rows * _cols - 1)));
+          buildLog(std::format("Id {} out of range 0-{}", index, max_size() - 1)));
     }
     _matrix.insert_or_assign(index, value);
   }
@@ -352,13 +354,14 @@ namespace dsm {
         }
         this->reshape(_rows + delta);
       } else {
-        if (!((i * (_cols + delta) + j) < (_rows + delta) * (_cols + delta))) {
+        if (!((static_cast<uint64_t>(i) * (_cols + delta) + j) <
+              static_cast<uint64_t>(_rows + delta) * (_cols + delta))) {
           ++delta;
         }
         this->reshape(_rows + delta, _cols + delta);
       }
     }
-    _matrix.insert_or_assign(i * _cols + j, value);
+    _matrix.insert_or_assign(static_cast<uint64_t>(i) * _cols + j, value);
   }
 
   template <typename T>
@@ -367,18 +370,18 @@ namespace dsm {
       throw std::out_of_range(
           buildLog(std::format("Id ({}, {}) out of range ({}, {})", i, j, _rows, _cols)));
     }
-    if (_matrix.find(i * _cols + j) == _matrix.end()) {
+    if (_matrix.find(static_cast<uint64_t>(i) * _cols + j) == _matrix.end()) {
       throw std::runtime_error(
-          buildLog(std::format("Element with index {} not found", i * _cols + j)));
+          buildLog(std::format("Element with index {} not found", static_cast<uint64_t>(i) * _cols + j)));
     }
-    _matrix.erase(i * _cols + j);
+    _matrix.erase(static_cast<uint64_t>(i) * _cols + j);
   }
 
   template <typename T>
-  void SparseMatrix<T>::erase(Id index) {
-    if (index > _rows * _cols - 1) {
+  void SparseMatrix<T>::erase(uint64_t index) {
+    if (index > max_size() - 1) {
       throw std::out_of_range(
-          buildLog(std::format("Id {} out of range 0-{}", index, _rows * _cols - 1)));
+          buildLog(std::format("Id {} out of range 0-{}", index, max_size() - 1)));
     }
     if (_matrix.find(index) == _matrix.end()) {
       throw std::runtime_error(
@@ -394,9 +397,9 @@ namespace dsm {
           buildLog(std::format("Id {} out of range 0-{}", index, _rows - 1)));
     }
     for (Id i = 0; i < _cols; ++i) {
-      _matrix.erase(index * _cols + i);
+      _matrix.erase(static_cast<uint64_t>(index) * _cols + i);
     }
-    std::unordered_map<Id, T> new_matrix = {};
+    std::unordered_map<uint64_t, T> new_matrix = {};
     for (auto const& [key, value] : _matrix) {
       if (key / _cols < index) {
         new_matrix.emplace(std::make_pair(key, value));
@@ -415,9 +418,9 @@ namespace dsm {
           buildLog(std::format("Id {} out of range 0-{}", index, _cols - 1)));
     }
     for (Id i = 0; i < _rows; ++i) {
-      _matrix.erase(i * _cols + index);
+      _matrix.erase(static_cast<uint64_t>(i) * _cols + index);
     }
-    std::unordered_map<Id, T> new_matrix = {};
+    std::unordered_map<uint64_t, T> new_matrix = {};
     for (auto const& [key, value] : _matrix) {
       if (key % _cols < index) {
         new_matrix.emplace(std::make_pair(key - key / _cols, value));
@@ -433,7 +436,7 @@ namespace dsm {
   template <typename T>
   void SparseMatrix<T>::emptyRow(Id index) {
     for (const auto& x : this->getRow(index)) {
-      _matrix.erase(index * _cols + x.first);
+      _matrix.erase(static_cast<uint64_t>(index) * _cols + x.first);
     }
   }
 
@@ -457,14 +460,14 @@ namespace dsm {
       throw std::out_of_range(
           buildLog(std::format("Id ({}, {}) out of range ({}, {})", i, j, _rows, _cols)));
     }
-    return _matrix.contains(i * _cols + j);
+    return _matrix.contains(static_cast<uint64_t>(i) * _cols + j);
   }
 
   template <typename T>
-  bool SparseMatrix<T>::contains(Id const index) const {
-    if (index > _rows * _cols - 1) {
+  bool SparseMatrix<T>::contains(uint64_t const index) const {
+    if (index > max_size() - 1) {
       throw std::out_of_range(
-          buildLog(std::format("Id {} out of range 0-{}", index, _rows * _cols - 1)));
+          buildLog(std::format("Id {} out of range 0-{}", index, max_size() - 1)));
     }
     return _matrix.contains(index);
   }
@@ -601,7 +604,7 @@ namespace dsm {
     auto copy = _matrix;
     for (auto& it : copy) {
       _matrix.erase(it.first);
-      if (it.first < rows * cols) {
+      if (it.first < static_cast<uint64_t>(rows) * cols) {
         this->insert_or_assign(it.first / oldCols, it.first % oldCols, it.second);
       }
     }
@@ -626,7 +629,7 @@ namespace dsm {
       throw std::out_of_range(
           buildLog(std::format("Id ({}, {}) out of range ({}, {})", i, j, _rows, _cols)));
     }
-    auto const& it = _matrix.find(i * _cols + j);
+    auto const& it = _matrix.find(static_cast<uint64_t>(i) * _cols + j);
     return it != _matrix.end() ? it->second : _defaultReturn;
   }
 
@@ -636,25 +639,25 @@ namespace dsm {
       throw std::out_of_range(
           buildLog(std::format("Id ({}, {}) out of range ({}, {})", i, j, _rows, _cols)));
     }
-    auto const& it = _matrix.find(i * _cols + j);
+    auto const& it = _matrix.find(static_cast<uint64_t>(i) * _cols + j);
     return it != _matrix.end() ? it->second : _defaultReturn;
   }
 
   template <typename T>
-  const T& SparseMatrix<T>::operator()(Id index) const {
-    if (index >= _rows * _cols) {
+  const T& SparseMatrix<T>::operator()(uint64_t index) const {
+    if (index >= max_size()) {
       throw std::out_of_range(
-          buildLog(std::format("Id {} out of range 0-{}", index, _rows * _cols - 1)));
+          buildLog(std::format("Id {} out of range 0-{}", index, max_size() - 1)));
     }
     auto const& it = _matrix.find(index);
     return it != _matrix.end() ? it->second : _defaultReturn;
   }
 
   template <typename T>
-  T& SparseMatrix<T>::operator()(Id index) {
-    if (index >= _rows * _cols) {
+  T& SparseMatrix<T>::operator()(uint64_t index) {
+    if (index >= max_size()) {
       throw std::out_of_range(
-          buildLog(std::format("Id {} out of range 0-{}", index, _rows * _cols - 1)));
+          buildLog(std::format("Id {} out of range 0-{}", index, max_size() - 1)));
     }
     auto const& it = _matrix.find(index);
     return it != _matrix.end() ? it->second : _defaultReturn;
@@ -12,9 +12,8 @@ namespace dsm {
         m_transportCapacity{street.transportCapacity()},
         m_nLanes{street.nLanes()},
         m_name{street.name()} {
-    for (auto i{0}; i < street.nLanes(); ++i) {
-      m_exitQueues.push_back(dsm::queue<Size>());
-    }
+    m_exitQueues.assign(m_nLanes, RingBuffer<Id>(m_capacity));
+    m_waitingAgents.reserve(m_capacity);
     m_laneMapping = street.laneMapping();
   }
 
@@ -27,7 +26,8 @@ namespace dsm {
         m_capacity{1},
         m_transportCapacity{1},
         m_nLanes{1} {
-    m_exitQueues.push_back(dsm::queue<Size>());
+    m_exitQueues.emplace_back(m_capacity);
+    m_waitingAgents.reserve(m_capacity);
     m_laneMapping.emplace_back(Direction::ANY);
   }
 
@@ -40,7 +40,8 @@ namespace dsm {
         m_capacity{capacity},
         m_transportCapacity{1},
         m_nLanes{1} {
-    m_exitQueues.push_back(dsm::queue<Size>());
+    m_exitQueues.emplace_back(m_capacity);
+    m_waitingAgents.reserve(m_capacity);
     m_laneMapping.emplace_back(Direction::ANY);
   }
 
@@ -54,7 +55,8 @@ namespace dsm {
         m_transportCapacity{1},
         m_nLanes{1} {
     this->setMaxSpeed(maxSpeed);
-    m_exitQueues.push_back(dsm::queue<Size>());
+    m_exitQueues.emplace_back(m_capacity);
+    m_waitingAgents.reserve(m_capacity);
     m_laneMapping.emplace_back(Direction::ANY);
   }
 
@@ -75,12 +77,9 @@ namespace dsm {
 
   {
     this->setMaxSpeed(maxSpeed);
-    this->setCapacity(capacity);
     this->setNLanes(nLanes);
     m_exitQueues.resize(nLanes);
-    for (auto i{0}; i < nLanes; ++i) {
-      m_exitQueues.push_back(dsm::queue<Size>());
-    }
+    this->setCapacity(capacity);
     switch (nLanes) {
       case 1:
         m_laneMapping.emplace_back(Direction::ANY);
@@ -104,6 +103,20 @@ namespace dsm {
     }
   }
 
+  void Street::setCapacity(Size capacity) {
+    m_capacity = capacity;
+    m_waitingAgents.reserve(capacity);
+    for (auto& queue : m_exitQueues) {
+      queue.reserve(capacity);
+    }
+  }
+
+  void Street::setQueue(RingBuffer<Id> queue, size_t index) {
+    m_nExitingAgents -= static_cast<Size>(m_exitQueues[index].size());
+    m_nExitingAgents += static_cast<Size>(queue.size());
+    m_exitQueues[index] = std::move(queue);
+  }
+
   void Street::setLength(double len) {
     if (len < 0.) {
       throw std::invalid_argument(
@@ -144,15 +157,18 @@ namespace dsm {
     m_nLanes = nLanes;
   }
 
-  void Street::addAgent(Id agentId) {
+  void Street::addAgent(Id agentId, double speed) {
     assert((void("Agent is already on the street."), !m_waitingAgents.contains(agentId)));
     for (auto const& queue : m_exitQueues) {
       for (auto const& id : queue) {
         assert((void("Agent is already in queue."), id != agentId));
       }
     }
-    m_waitingAgents.insert(agentId);
-    ;
+    m_waitingAgents.push(agentId);
+    m_speedSum += speed;
+    if (m_bSpire) {
+      ++m_agentCounterIn;
+    }
   }
   void Street::enqueue(Id agentId, size_t index) {
     assert((void("Agent is not on the street."), m_waitingAgents.contains(agentId)));
@@ -163,6 +179,7 @@ namespace dsm {
     }
     m_waitingAgents.erase(agentId);
     m_exitQueues[index].push(agentId);
+    ++m_nExitingAgents;
   }
   std::optional<Id> Street::dequeue(size_t index) {
     if (m_exitQueues[index].empty()) {
@@ -170,28 +187,15 @@ namespace dsm {
     }
     Id id = m_exitQueues[index].front();
     m_exitQueues[index].pop();
-    return id;
-  }
-
-  Size Street::nAgents() const {
-    Size nAgents{static_cast<Size>(m_waitingAgents.size())};
-    for (const auto& queue : m_exitQueues) {
-      nAgents += queue.size();
+    --m_nExitingAgents;
+    if (this->nAgents() == 0) {
+      // restart from zero on an empty street, so that rounding errors do not pile up
+      m_speedSum = 0.;
     }
-    return nAgents;
-  }
-
-  double Street::density(bool normalized) const {
-    return normalized ? nAgents() / static_cast<double>(m_capacity)
-                      : nAgents() / (m_len * m_nLanes);
-  }
-
-  Size Street::nExitingAgents() const {
-    Size nAgents{0};
-    for (const auto& queue : m_exitQueues) {
-      nAgents += queue.size();
+    if (m_bSpire) {
+      ++m_agentCounterOut;
     }
-    return nAgents;
+    return id;
   }
 
   double Street::deltaAngle(double const previousStreetAngle) const {
@@ -204,21 +208,19 @@ namespace dsm {
     return deltaAngle;
   }
 
-  SpireStreet::SpireStreet(Id id, const Street& street)
-      : Street(id, street), m_agentCounterIn{0}, m_agentCounterOut{0} {}
+  SpireStreet::SpireStreet(Id id, const Street& street) : Street(id, street) {
+    m_bSpire = true;
+  }
 
   SpireStreet::SpireStreet(Id id, Size capacity, double len, std::pair<Id, Id> nodePair)
-      : Street(id, capacity, len, nodePair), m_agentCounterIn{0}, m_agentCounterOut{0} {}
+      : Street(id, capacity, len, nodePair) {
+    m_bSpire = true;
+  }
 
   SpireStreet::SpireStreet(
       Id id, Size capacity, double len, double maxSpeed, std::pair<Id, Id> nodePair)
-      : Street(id, capacity, len, maxSpeed, nodePair),
-        m_agentCounterIn{0},
-        m_agentCounterOut{0} {}
-
-  void SpireStreet::addAgent(Id agentId) {
-    Street::addAgent(agentId);
-    ++m_agentCounterIn;
+      : Street(id, capacity, len, maxSpeed, nodePair) {
+    m_bSpire = true;
   }
 
   Size SpireStreet::inputCounts(bool resetValue) {
@@ -244,12 +246,4 @@ namespace dsm {
     return flow;
   }
 
-  std::optional<Id> SpireStreet::dequeue(size_t index) {
-    std::optional<Id> id = Street::dequeue(index);
-    if (id.has_value()) {
-      ++m_agentCounterOut;
-    }
-    return id;
-  }
-
 };  // namespace dsm
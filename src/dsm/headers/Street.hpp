@@ -9,13 +9,11 @@
 #pragma once
 
 #include <optional>
-#include <queue>
 #include <type_traits>
 #include <utility>
 #include <stdexcept>
 #include <cmath>
 #include <numbers>
-#include <set>
 #include <format>
 #include <cassert>
 #include <string>
@@ -23,7 +21,7 @@
 #include "Agent.hpp"
 #include "Node.hpp"
 #include "../utility/TypeTraits/is_numeric.hpp"
-#include "../utility/queue.hpp"
+#include "../utility/RingBuffer.hpp"
 #include "../utility/Logger.hpp"
 #include "../utility/Typedef.hpp"
 
@@ -33,10 +31,12 @@ namespace dsm {
   /// @tparam Size, The type of the street's capacity. It must be an unsigned integral type.
   class Street {
   private:
-    std::vector<dsm::queue<Size>> m_exitQueues;
+    std::vector<RingBuffer<Id>> m_exitQueues;
     std::vector<Direction> m_laneMapping;
-    std::set<Id> m_waitingAgents;
+    RingBuffer<Id> m_waitingAgents;
     std::pair<Id, Id> m_nodePair;
+    double m_speedSum{0.};
+    Size m_nExitingAgents{0};
     double m_len;
     double m_maxSpeed;
     double m_angle;
@@ -46,6 +46,11 @@ namespace dsm {
     int16_t m_transportCapacity;
     int16_t m_nLanes;
 
+  protected:
+    Size m_agentCounterIn{0};
+    Size m_agentCounterOut{0};
+    bool m_bSpire{false};
+
   public:
     /// @brief Construct a new Street object starting from an existing street
     /// @details The new street has different id but same capacity, length, speed limit, and node pair as the
@@ -97,7 +102,9 @@ namespace dsm {
     void setId(Id id) { m_id = id; }
     /// @brief Set the street's capacity
     /// @param capacity The street's capacity
-    void setCapacity(Size capacity) { m_capacity = capacity; }
+    /// @details The exit queues and the buffer of the travelling agents are preallocated to
+    /// hold the whole capacity, so that moving agents along the street never allocates.
+    void setCapacity(Size capacity);
     /// @brief Set the street's transport capacity
     /// @details The transport capacity is the maximum number of agents that can traverse the street
     ///          in a time step.
@@ -109,9 +116,7 @@ namespace dsm {
     void setLength(double len);
     /// @brief Set the street's queue
     /// @param queue The street's queue
-    inline void setQueue(dsm::queue<Size> queue, size_t index) {
-      m_exitQueues[index] = std::move(queue);
-    }
+    void setQueue(RingBuffer<Id> queue, size_t index);
     /// @brief Set the street's node pair
     /// @param node1 The source node of the street
     /// @param node2 The destination node of the street
@@ -157,24 +162,38 @@ namespace dsm {
     /// @return double, The street's length
     double length() const { return m_len; }
     /// @brief Get the street's waiting agents
-    /// @return std::set<Id>, The street's waiting agents
-    const std::set<Id>& waitingAgents() const { return m_waitingAgents; }
+    /// @return RingBuffer<Id>, The street's waiting agents, in order of arrival
+    const RingBuffer<Id>& waitingAgents() const { return m_waitingAgents; }
     /// @brief Get the street's queue
-    /// @return dsm::queue<Size>, The street's queue
-    const dsm::queue<Size>& queue(size_t index) const { return m_exitQueues[index]; }
+    /// @return RingBuffer<Id>, The street's queue
+    const RingBuffer<Id>& queue(size_t index) const { return m_exitQueues[index]; }
     /// @brief Get the street's queues
-    /// @return std::vector<dsm::queue<Size>> The street's queues
-    const std::vector<dsm::queue<Size>>& exitQueues() const { return m_exitQueues; }
+    /// @return std::vector<RingBuffer<Id>> The street's queues
+    const std::vector<RingBuffer<Id>>& exitQueues() const { return m_exitQueues; }
     /// @brief Get the street's node pair
     /// @return std::pair<Id, Id>, The street's node pair
     const std::pair<Id, Id>& nodePair() const { return m_nodePair; }
     /// @brief  Get the number of agents on the street
     /// @return Size, The number of agents on the street
-    Size nAgents() const;
+    Size nAgents() const {
+      return static_cast<Size>(m_waitingAgents.size()) + m_nExitingAgents;
+    }
     /// @brief Get the street's density in \f$m^{-1}\f$ or in \f$a.u.\f$, if normalized
     /// @param normalized If true, the street's density is normalized by the street's capacity
     /// @return double, The street's density
-    double density(bool normalized = false) const;
+    double density(bool normalized = false) const {
+      return normalized ? nAgents() / static_cast<double>(m_capacity)
+                        : nAgents() / (m_len * m_nLanes);
+    }
+    /// @brief Get the sum of the speeds of the agents on the street
+    /// @return double The sum of the speeds, in \f$m/s\f$
+    double speedSum() const { return m_speedSum; }
+    /// @brief Get the mean speed of the agents on the street
+    /// @return double The mean speed, in \f$m/s\f$, or 0 if the street is empty
+    double meanSpeed() const {
+      auto const n{nAgents()};
+      return n == 0 ? 0. : m_speedSum / n;
+    }
     /// @brief Check if the street is full
     /// @return bool, True if the street is full, false otherwise
     bool isFull() const { return nAgents() == m_capacity; }
@@ -192,7 +211,7 @@ namespace dsm {
     std::string_view name() const { return m_name; }
     /// @brief Get the number of agents on all queues
     /// @return Size The number of agents on all queues
-    Size nExitingAgents() const;
+    Size nExitingAgents() const { return m_nExitingAgents; }
     /// @brief Get the delta angle between the street and the previous street, normalized between -pi and pi
     /// @param previousStreetAngle The angle of the previous street
     /// @return double The delta angle between the street and the previous street
@@ -200,26 +219,33 @@ namespace dsm {
 
     inline std::vector<Direction> const& laneMapping() const { return m_laneMapping; }
 
-    virtual void addAgent(Id agentId);
+    /// @brief Add an agent to the street
+    /// @param agentId The id of the agent
+    /// @param speed The speed of the agent along the street (default is 0)
+    /// @details If the street is a spire, the agent is counted in the input flow.
+    void addAgent(Id agentId, double speed = 0.);
     /// @brief Add an agent to the street's queue
     /// @param agentId The id of the agent to add to the street's queue
     /// @throw std::runtime_error If the street's queue is full
     void enqueue(Id agentId, size_t index);
+    /// @brief Notify the street that one of its agents has stopped
+    /// @param speed The speed the agent was moving at
+    void stopAgent(double speed) { m_speedSum -= speed; }
     /// @brief Remove an agent from the street's queue
-    virtual std::optional<Id> dequeue(size_t index);
+    /// @details If the street is a spire, the agent is counted in the output flow.
+    ///          The agent must have been stopped, see stopAgent.
+    std::optional<Id> dequeue(size_t index);
     /// @brief Check if the street is a spire
     /// @return bool True if the street is a spire, false otherwise
-    virtual bool isSpire() const { return false; };
+    bool isSpire() const { return m_bSpire; };
   };
 
   /// @brief The SpireStreet class represents a street which is able to count agent flows in both input and output.
   /// @tparam Id The type of the street's id
   /// @tparam Size The type of the street's capacity
+  /// @details The counting itself is done by the Street class when the spire flag is set,
+  ///          so that moving agents along any street needs no virtual call.
   class SpireStreet : public Street {
-  private:
-    Size m_agentCounterIn;
-    Size m_agentCounterOut;
-
   public:
     /// @brief Construct a new SpireStreet object starting from an existing street
     /// @param id The street's id
@@ -241,11 +267,6 @@ namespace dsm {
         Id id, Size capacity, double len, double maxSpeed, std::pair<Id, Id> nodePair);
     ~SpireStreet() = default;
 
-    /// @brief Add an agent to the street's queue
-    /// @param agentId The id of the agent to add to the street's queue
-    /// @throw std::runtime_error If the street's queue is full
-    void addAgent(Id agentId) override;
-
     /// @brief Get the input counts of the street
     /// @param resetValue If true, the counter is reset to 0 together with the output counter.
     /// @return Size The input counts of the street
@@ -259,12 +280,6 @@ namespace dsm {
     /// @details Once the flow is retrieved, bothh the input and output flows are reset to 0.
     ///     Notice that this flow is positive iff the input flow is greater than the output flow.
     int meanFlow();
-    /// @brief Remove an agent from the street's queue
-    /// @return std::optional<Id> The id of the agent removed from the street's queue
-    std::optional<Id> dequeue(size_t index) override;
-    /// @brief Check if the street is a spire
-    /// @return bool True if the street is a spire, false otherwise
-    bool isSpire() const final { return true; };
   };
 
 };  // namespace dsm
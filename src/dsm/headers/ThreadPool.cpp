@@ -0,0 +1,162 @@
+
+#include "ThreadPool.hpp"
+
+namespace dsm {
+  namespace {
+    // the pool whose loop the current thread is running, if any
+    thread_local const ThreadPool* tl_pCurrentPool{nullptr};
+  }  // namespace
+
+  ThreadPool::ThreadPool(std::optional<std::size_t> nWorkers)
+      : m_task{nullptr}, m_pending{0}, m_nActive{0}, m_generation{0}, m_stop{false} {
+    if (!nWorkers.has_value()) {
+      auto const nThreads{static_cast<std::size_t>(std::thread::hardware_concurrency())};
+      nWorkers = nThreads > 1 ? nThreads - 1 : 0;
+    }
+    // the last queue belongs to the calling thread
+    m_queues.reserve(nWorkers.value() + 1);
+    for (std::size_t i{0}; i <= nWorkers.value(); ++i) {
+      m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+    m_workers.reserve(nWorkers.value());
+    for (std::size_t i{0}; i < nWorkers.value(); ++i) {
+      m_workers.emplace_back([this, i] { this->m_workerLoop(i); });
+    }
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_wakeCondition.notify_all();
+    for (auto& worker : m_workers) {
+      worker.join();
+    }
+  }
+
+  std::shared_ptr<ThreadPool> ThreadPool::defaultPool() {
+    static auto pPool{std::make_shared<ThreadPool>()};
+    return pPool;
+  }
+
+  void ThreadPool::m_workerLoop(std::size_t queueIndex) {
+    tl_pCurrentPool = this;
+    std::size_t generation{0};
+    while (true) {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wakeCondition.wait(lock, [this, generation] {
+        return m_stop || m_generation != generation;
+      });
+      if (m_stop) {
+        return;
+      }
+      generation = m_generation;
+      ++m_nActive;
+      lock.unlock();
+      this->m_drain(queueIndex);
+      lock.lock();
+      if (--m_nActive == 0) {
+        m_doneCondition.notify_all();
+      }
+    }
+  }
+
+  std::optional<std::size_t> ThreadPool::m_nextIndex(std::size_t queueIndex) {
+    {
+      auto& queue{*m_queues[queueIndex]};
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.indices.empty()) {
+        auto const index{queue.indices.front()};
+        queue.indices.pop_front();
+        return index;
+      }
+    }
+    // own queue is empty: steal from the back of the others
+    auto const nQueues{m_queues.size()};
+    for (std::size_t offset{1}; offset < nQueues; ++offset) {
+      auto& queue{*m_queues[(queueIndex + offset) % nQueues]};
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.indices.empty()) {
+        auto const index{queue.indices.back()};
+        queue.indices.pop_back();
+        return index;
+      }
+    }
+    return std::nullopt;
+  }
+
+  void ThreadPool::m_drain(std::size_t queueIndex) {
+    while (auto const index = this->m_nextIndex(queueIndex)) {
+      try {
+        (*m_task)(index.value());
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(m_exceptionMutex);
+        if (!m_pException) {
+          m_pException = std::current_exception();
+        }
+      }
+      if (m_pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_doneCondition.notify_all();
+      }
+    }
+  }
+
+  void ThreadPool::parallelFor(std::size_t n,
+                               const std::function<void(std::size_t)>& task) {
+    if (n == 0) {
+      return;
+    }
+    if (tl_pCurrentPool == this) {
+      // nested call from a task of this pool: the workers are busy, so run it inline
+      std::exception_ptr pException;
+      for (std::size_t index{0}; index < n; ++index) {
+        try {
+          task(index);
+        } catch (...) {
+          if (!pException) {
+            pException = std::current_exception();
+          }
+        }
+      }
+      if (pException) {
+        std::rethrow_exception(pException);
+      }
+      return;
+    }
+    std::lock_guard<std::mutex> submitLock(m_submitMutex);
+    auto const* pPreviousPool{tl_pCurrentPool};
+    tl_pCurrentPool = this;
+    m_task = &task;
+    m_pException = nullptr;
+    m_pending = n;
+    // give each queue a contiguous block of indices
+    auto const nQueues{m_queues.size()};
+    for (std::size_t i{0}; i < nQueues; ++i) {
+      auto& queue{*m_queues[i]};
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      for (auto index{i * n / nQueues}; index < (i + 1) * n / nQueues; ++index) {
+        queue.indices.push_back(index);
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      ++m_generation;
+    }
+    m_wakeCondition.notify_all();
+    this->m_drain(nQueues - 1);
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_doneCondition.wait(lock, [this] { return m_pending == 0 && m_nActive == 0; });
+    }
+    m_task = nullptr;
+    tl_pCurrentPool = pPreviousPool;
+    if (m_pException) {
+      std::rethrow_exception(m_pException);
+    }
+  }
+
+  std::size_t ThreadPool::nWorkers() const { return m_workers.size(); }
+  std::size_t ThreadPool::concurrency() const { return m_workers.size() + 1; }
+};  // namespace dsm
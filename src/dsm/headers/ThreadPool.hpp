@@ -0,0 +1,89 @@
+/// @file       /src/dsm/headers/ThreadPool.hpp
+/// @brief      Defines the ThreadPool class.
+///
+/// @details    This file contains the definition of the ThreadPool class.
+///             The ThreadPool class holds a set of persistent worker threads which execute
+///             parallel loops. Each worker owns a queue of indices and, when its queue is
+///             empty, steals indices from the queues of the other workers, so that loops
+///             with very uneven iteration costs stay balanced.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace dsm {
+  /// @brief The ThreadPool class represents a pool of persistent worker threads.
+  /// @details The calling thread takes part in every parallel loop, so a pool with zero
+  ///          workers runs the loops serially on the caller.
+  class ThreadPool {
+  private:
+    struct WorkQueue {
+      std::mutex mutex;
+      std::deque<std::size_t> indices;
+    };
+
+    std::vector<std::thread> m_workers;
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::mutex m_mutex;
+    std::mutex m_submitMutex;
+    std::condition_variable m_wakeCondition;
+    std::condition_variable m_doneCondition;
+    const std::function<void(std::size_t)>* m_task;
+    std::atomic<std::size_t> m_pending;
+    std::size_t m_nActive;
+    std::size_t m_generation;
+    bool m_stop;
+    std::mutex m_exceptionMutex;
+    std::exception_ptr m_pException;
+
+    /// @brief The main loop of a worker thread
+    /// @param queueIndex The index of the queue owned by the worker
+    void m_workerLoop(std::size_t queueIndex);
+    /// @brief Pop an index from the given queue or steal one from the other queues
+    /// @param queueIndex The index of the queue owned by the calling thread
+    /// @return The index, or std::nullopt if all the queues are empty
+    std::optional<std::size_t> m_nextIndex(std::size_t queueIndex);
+    /// @brief Run tasks until all the queues are empty
+    /// @param queueIndex The index of the queue owned by the calling thread
+    void m_drain(std::size_t queueIndex);
+
+  public:
+    /// @brief Construct a new ThreadPool object
+    /// @param nWorkers The number of worker threads. Defaults to the number of hardware
+    /// threads minus one, since the calling thread also executes tasks.
+    explicit ThreadPool(std::optional<std::size_t> nWorkers = std::nullopt);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    /// @brief Get the library-wide thread pool
+    /// @return A std::shared_ptr to the default ThreadPool, created on first use
+    static std::shared_ptr<ThreadPool> defaultPool();
+
+    /// @brief Run a task for every index in [0, n) and wait for all of them to finish
+    /// @param n The number of indices
+    /// @param task The task to run, taking the index as argument
+    /// @throw Rethrows the first exception thrown by a task, after all the other tasks
+    /// have completed
+    /// @details Concurrent calls from different threads are serialized. A call made by a
+    /// task of this pool, i.e. a nested parallel loop, is run serially on the calling thread.
+    void parallelFor(std::size_t n, const std::function<void(std::size_t)>& task);
+
+    /// @brief Get the number of worker threads
+    /// @return std::size_t The number of worker threads
+    std::size_t nWorkers() const;
+    /// @brief Get the number of threads which execute a parallel loop
+    /// @return std::size_t The number of worker threads plus the calling thread
+    std::size_t concurrency() const;
+  };
+};  // namespace dsm
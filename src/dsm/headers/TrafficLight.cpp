@@ -131,25 +131,44 @@ namespace dsm {
       throw std::invalid_argument(buildLog(
           std::format("Street id {} is not valid for node {}.", streetId, id())));
     }
+    return m_isGreen(streetId, direction, m_counter);
+  }
+
+  std::optional<Delay> TrafficLight::ticksToGreen(Id const streetId,
+                                                  Direction direction) const {
+    if (!m_cycles.contains(streetId)) {
+      throw std::invalid_argument(buildLog(
+          std::format("Street id {} is not valid for node {}.", streetId, id())));
+    }
+    for (Delay ticks{0}; ticks < m_cycleTime; ++ticks) {
+      if (m_isGreen(streetId, direction, (m_counter + ticks) % m_cycleTime)) {
+        return ticks;
+      }
+    }
+    return std::nullopt;
+  }
+
+  bool TrafficLight::m_isGreen(Id const streetId,
+                               Direction direction,
+                               Delay const counter) const {
     switch (direction) {
       case Direction::UTURN:
         direction = Direction::LEFT;
         break;
       case Direction::RIGHTANDSTRAIGHT:
-        return m_cycles.at(streetId)[Direction::RIGHT].isGreen(m_cycleTime, m_counter) &&
-               m_cycles.at(streetId)[Direction::STRAIGHT].isGreen(m_cycleTime, m_counter);
+        return m_cycles.at(streetId)[Direction::RIGHT].isGreen(m_cycleTime, counter) &&
+               m_cycles.at(streetId)[Direction::STRAIGHT].isGreen(m_cycleTime, counter);
       case Direction::LEFTANDSTRAIGHT:
-        return m_cycles.at(streetId)[Direction::LEFT].isGreen(m_cycleTime, m_counter) &&
-               m_cycles.at(streetId)[Direction::STRAIGHT].isGreen(m_cycleTime, m_counter);
+        return m_cycles.at(streetId)[Direction::LEFT].isGreen(m_cycleTime, counter) &&
+               m_cycles.at(streetId)[Direction::STRAIGHT].isGreen(m_cycleTime, counter);
       case Direction::ANY:
-        return m_cycles.at(streetId)[Direction::RIGHT].isGreen(m_cycleTime, m_counter) &&
-               m_cycles.at(streetId)[Direction::STRAIGHT].isGreen(m_cycleTime,
-                                                                  m_counter) &&
-               m_cycles.at(streetId)[Direction::LEFT].isGreen(m_cycleTime, m_counter);
+        return m_cycles.at(streetId)[Direction::RIGHT].isGreen(m_cycleTime, counter) &&
+               m_cycles.at(streetId)[Direction::STRAIGHT].isGreen(m_cycleTime, counter) &&
+               m_cycles.at(streetId)[Direction::LEFT].isGreen(m_cycleTime, counter);
       default:
         break;
     }
-    return m_cycles.at(streetId)[direction].isGreen(m_cycleTime, m_counter);
+    return m_cycles.at(streetId)[direction].isGreen(m_cycleTime, counter);
   }
 
   void TrafficLight::resetCycles() {
@@ -11,6 +11,8 @@
 
 #include "Intersection.hpp"
 
+#include <optional>
+
 namespace dsm {
   class TrafficLightCycle {
   private:
@@ -45,6 +47,12 @@ namespace dsm {
     Delay m_cycleTime;  // The total time of a red-green cycle
     Delay m_counter;
 
+    /// @brief Returns true if the traffic light is green for a street and a direction
+    /// @param streetId Id, the street's id
+    /// @param direction Direction, the direction
+    /// @param counter Delay, the value of the counter
+    bool m_isGreen(Id const streetId, Direction direction, Delay const counter) const;
+
   public:
     /// @brief Construct a new TrafficLight object
     /// @param id The node's id
@@ -103,6 +111,12 @@ namespace dsm {
     /// @param direction Direction, the direction
     /// @return true if the traffic light is green for the street and direction
     bool isGreen(Id const streetId, Direction direction) const;
+    /// @brief Returns the number of ticks after which the light turns green for a street and a direction
+    /// @param streetId Id, the street's id
+    /// @param direction Direction, the direction
+    /// @return std::optional<Delay> The number of ticks, zero if the light is green, or std::nullopt if it is never green
+    /// @throw std::invalid_argument if the street id is not valid
+    std::optional<Delay> ticksToGreen(Id const streetId, Direction direction) const;
     /// @brief Resets all traffic light cycles
     /// @details For more info, see @ref TrafficLightCycle::reset()
     void resetCycles();
@@ -0,0 +1,135 @@
+/// @file utility/ActiveSet.hpp
+/// @brief This file contains the definition of the ActiveSet class.
+///
+/// @details The ActiveSet class is a set of dense indices, stored as a two-level bitset.
+///          Each bit of the summary level tells whether a word of the lower level has any
+///          bit set, so looking for the next element skips empty regions 4096 indices at a
+///          time.
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace dsm {
+
+  /// @brief The ActiveSet class holds a subset of the indices in [0, n)
+  /// @details Insertions and removals are O(1). The elements are visited in increasing
+  ///          order, so that a loop over the active elements follows the same order as a
+  ///          loop over all of them.
+  class ActiveSet {
+  private:
+    static constexpr std::size_t m_wordBits{64};
+
+    std::vector<uint64_t> m_words;
+    std::vector<uint64_t> m_summary;
+    std::size_t m_size{0};
+
+  public:
+    ActiveSet() = default;
+    /// @brief Construct a new ActiveSet object
+    /// @param n The number of indices which can be inserted
+    explicit ActiveSet(std::size_t n) { resize(n); }
+
+    /// @brief Set the number of indices which can be inserted, clearing the set
+    /// @param n The number of indices
+    void resize(std::size_t n) {
+      m_words.assign((n + m_wordBits - 1) / m_wordBits, 0);
+      m_summary.assign((m_words.size() + m_wordBits - 1) / m_wordBits, 0);
+      m_size = 0;
+    }
+    /// @brief Remove all the elements
+    void clear() {
+      std::fill(m_words.begin(), m_words.end(), 0);
+      std::fill(m_summary.begin(), m_summary.end(), 0);
+      m_size = 0;
+    }
+    /// @brief Insert an index
+    /// @param index The index, which must be smaller than the size given to resize
+    void insert(std::size_t index) {
+      auto& word{m_words[index / m_wordBits]};
+      auto const bit{uint64_t{1} << (index % m_wordBits)};
+      if (word & bit) {
+        return;
+      }
+      word |= bit;
+      m_summary[index / (m_wordBits * m_wordBits)] |= uint64_t{1}
+                                                      << (index / m_wordBits % m_wordBits);
+      ++m_size;
+    }
+    /// @brief Remove an index
+    /// @param index The index
+    void erase(std::size_t index) {
+      auto& word{m_words[index / m_wordBits]};
+      auto const bit{uint64_t{1} << (index % m_wordBits)};
+      if (!(word & bit)) {
+        return;
+      }
+      word &= ~bit;
+      if (word == 0) {
+        m_summary[index / (m_wordBits * m_wordBits)] &=
+            ~(uint64_t{1} << (index / m_wordBits % m_wordBits));
+      }
+      --m_size;
+    }
+    /// @brief Check if an index is in the set
+    /// @param index The index
+    /// @return bool True if the index is in the set, false otherwise
+    bool contains(std::size_t index) const {
+      return index / m_wordBits < m_words.size() &&
+             (m_words[index / m_wordBits] >> (index % m_wordBits) & 1);
+    }
+    /// @brief Get the number of elements
+    /// @return std::size_t The number of elements in the set
+    std::size_t size() const { return m_size; }
+    /// @brief Check if the set is empty
+    /// @return bool True if the set is empty, false otherwise
+    bool empty() const { return m_size == 0; }
+
+    /// @brief Get the smallest element not smaller than an index
+    /// @param from The index
+    /// @return std::optional<std::size_t> The element, or std::nullopt if there is none
+    std::optional<std::size_t> next(std::size_t from) const {
+      auto w{from / m_wordBits};
+      if (w >= m_words.size()) {
+        return std::nullopt;
+      }
+      auto const word{m_words[w] & (~uint64_t{0} << (from % m_wordBits))};
+      if (word != 0) {
+        return w * m_wordBits + std::countr_zero(word);
+      }
+      // look for the next non-empty word in the summary
+      ++w;
+      for (auto s{w / m_wordBits}; s < m_summary.size(); ++s) {
+        auto summary{m_summary[s]};
+        if (s == w / m_wordBits) {
+          summary &= ~uint64_t{0} << (w % m_wordBits);
+        }
+        if (summary != 0) {
+          auto const nextWord{s * m_wordBits + std::countr_zero(summary)};
+          return nextWord * m_wordBits + std::countr_zero(m_words[nextWord]);
+        }
+      }
+      return std::nullopt;
+    }
+    /// @brief Visit the elements in increasing order, keeping only some of them
+    /// @param keep A callable taking an index and returning false if the index must be
+    /// removed from the set
+    /// @details The callable may insert or erase other indices. Indices inserted after the
+    /// current one are visited in the same call.
+    template <typename F>
+    void retainIf(F&& keep) {
+      std::size_t from{0};
+      while (auto const index = next(from)) {
+        from = index.value() + 1;
+        if (!keep(index.value())) {
+          erase(index.value());
+        }
+      }
+    }
+  };
+};  // namespace dsm
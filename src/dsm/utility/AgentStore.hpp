@@ -0,0 +1,276 @@
+/// @file utility/AgentStore.hpp
+/// @brief This file contains the definition of the AgentStore class.
+///
+/// @details The AgentStore class is a dense container of agents, indexed by their id.
+///          Agents live in contiguous slots which are recycled through a free list, while
+///          a paged table maps each id to its slot. Lookups by id are O(1) and iteration
+///          walks the ids in increasing order, as a std::map would.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <format>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Logger.hpp"
+#include "Typedef.hpp"
+
+namespace dsm {
+
+  /// @brief The AgentStore class holds the agents of a simulation.
+  /// @tparam agent_t The type of the agents
+  /// @details Slots are stored in a std::deque, so the address of an agent never changes
+  ///          while it is in the store. The id table is split in pages, which are allocated
+  ///          on first use and released once empty, and the ids in use are kept in a sorted
+  ///          vector, where erased ids are dropped lazily. Hence the memory and the cost of
+  ///          an iteration follow the number of agents, not the largest id ever inserted.
+  ///          Inserting or erasing agents invalidates the iterators.
+  template <typename agent_t>
+  class AgentStore {
+  private:
+    static constexpr Size m_noSlot{std::numeric_limits<Size>::max()};
+    static constexpr Id m_pageBits{12};
+    static constexpr Id m_pageSize{Id{1} << m_pageBits};
+
+    struct Page {
+      std::array<Size, m_pageSize> slots;
+      Size nUsed{0};
+
+      Page() { slots.fill(m_noSlot); }
+    };
+
+    std::deque<std::optional<agent_t>> m_slots;
+    std::vector<Size> m_freeSlots;
+    std::vector<std::unique_ptr<Page>> m_pages;
+    // sorted, may still hold erased ids until the next compaction
+    std::vector<Id> m_ids;
+    Size m_nErasedIds{0};
+    Size m_size{0};
+
+    /// @brief Get the slot of an agent
+    /// @param id The agent's id
+    /// @return Size The slot, or m_noSlot if the agent is not in the store
+    Size m_slotOf(Id id) const {
+      auto const page{static_cast<std::size_t>(id >> m_pageBits)};
+      if (page >= m_pages.size() || !m_pages[page]) {
+        return m_noSlot;
+      }
+      return m_pages[page]->slots[id & (m_pageSize - 1)];
+    }
+    /// @brief Drop the erased ids from the id vector, once they are as many as the agents
+    void m_compactIds() {
+      while (!m_ids.empty() && !contains(m_ids.back())) {
+        m_ids.pop_back();
+        --m_nErasedIds;
+      }
+      if (m_nErasedIds > m_size) {
+        std::erase_if(m_ids, [this](Id id) { return !contains(id); });
+        m_nErasedIds = 0;
+      }
+    }
+
+    template <typename store_t, typename pointer_t>
+    class Iterator {
+    private:
+      store_t* m_pStore;
+      std::size_t m_index;
+
+      void m_skipErased() {
+        while (m_index < m_pStore->m_ids.size() &&
+               !m_pStore->contains(m_pStore->m_ids[m_index])) {
+          ++m_index;
+        }
+      }
+
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = std::pair<Id, pointer_t>;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = value_type;
+
+      Iterator() = default;
+      Iterator(store_t* pStore, std::size_t index) : m_pStore{pStore}, m_index{index} {
+        m_skipErased();
+      }
+
+      value_type operator*() const {
+        auto const id{m_pStore->m_ids[m_index]};
+        return {id, (*m_pStore)[id]};
+      }
+      Iterator& operator++() {
+        ++m_index;
+        m_skipErased();
+        return *this;
+      }
+      Iterator operator++(int) {
+        auto copy{*this};
+        ++(*this);
+        return copy;
+      }
+      bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+    };
+
+  public:
+    using iterator = Iterator<AgentStore, agent_t*>;
+    using const_iterator = Iterator<const AgentStore, const agent_t*>;
+
+    AgentStore() = default;
+
+    /// @brief Insert an agent in the store
+    /// @param agent The agent, whose id is used as key
+    /// @return agent_t* A pointer to the stored agent
+    /// @throw std::invalid_argument if an agent with the same id is already in the store
+    agent_t* insert(agent_t agent) {
+      auto const id{agent.id()};
+      if (contains(id)) {
+        throw std::invalid_argument(
+            buildLog(std::format("Agent with id {} already exists.", id)));
+      }
+      Size slot;
+      if (m_freeSlots.empty()) {
+        slot = static_cast<Size>(m_slots.size());
+        m_slots.emplace_back(std::move(agent));
+      } else {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        m_slots[slot].emplace(std::move(agent));
+      }
+      auto const page{static_cast<std::size_t>(id >> m_pageBits)};
+      if (page >= m_pages.size()) {
+        m_pages.resize(page + 1);
+      }
+      if (!m_pages[page]) {
+        m_pages[page] = std::make_unique<Page>();
+      }
+      m_pages[page]->slots[id & (m_pageSize - 1)] = slot;
+      ++m_pages[page]->nUsed;
+      // ids usually come in increasing order, e.g. from nextId
+      if (m_ids.empty() || id > m_ids.back()) {
+        m_ids.push_back(id);
+      } else if (auto const it = std::lower_bound(m_ids.begin(), m_ids.end(), id);
+                 *it == id) {
+        --m_nErasedIds;
+      } else {
+        m_ids.insert(it, id);
+      }
+      ++m_size;
+      return &m_slots[slot].value();
+    }
+    /// @brief Remove an agent from the store
+    /// @param id The agent's id
+    /// @return std::size_t The number of removed agents, i.e. 0 or 1
+    std::size_t erase(Id id) {
+      if (!contains(id)) {
+        return 0;
+      }
+      auto const page{static_cast<std::size_t>(id >> m_pageBits)};
+      auto& pPage{m_pages[page]};
+      auto const slot{pPage->slots[id & (m_pageSize - 1)]};
+      m_slots[slot].reset();
+      m_freeSlots.push_back(slot);
+      pPage->slots[id & (m_pageSize - 1)] = m_noSlot;
+      if (--pPage->nUsed == 0) {
+        pPage.reset();
+        while (!m_pages.empty() && !m_pages.back()) {
+          m_pages.pop_back();
+        }
+      }
+      --m_size;
+      ++m_nErasedIds;
+      m_compactIds();
+      return 1;
+    }
+    /// @brief Remove all the agents from the store
+    void clear() {
+      m_slots.clear();
+      m_freeSlots.clear();
+      m_pages.clear();
+      m_ids.clear();
+      m_nErasedIds = 0;
+      m_size = 0;
+    }
+
+    /// @brief Check if an agent is in the store
+    /// @param id The agent's id
+    /// @return bool True if the agent is in the store, false otherwise
+    bool contains(Id id) const { return m_slotOf(id) != m_noSlot; }
+    /// @brief Get an agent
+    /// @param id The agent's id
+    /// @return agent_t* A pointer to the agent
+    /// @throw std::out_of_range if the agent is not in the store
+    agent_t* at(Id id) {
+      if (!contains(id)) {
+        throw std::out_of_range(buildLog(std::format("Agent with id {} not found.", id)));
+      }
+      return (*this)[id];
+    }
+    /// @brief Get an agent
+    /// @param id The agent's id
+    /// @return const agent_t* A pointer to the agent
+    /// @throw std::out_of_range if the agent is not in the store
+    const agent_t* at(Id id) const {
+      if (!contains(id)) {
+        throw std::out_of_range(buildLog(std::format("Agent with id {} not found.", id)));
+      }
+      return (*this)[id];
+    }
+    /// @brief Get an agent, without bounds checking
+    /// @param id The agent's id, which must be in the store
+    /// @return agent_t* A pointer to the agent
+    agent_t* operator[](Id id) {
+      return &m_slots[m_pages[id >> m_pageBits]->slots[id & (m_pageSize - 1)]].value();
+    }
+    /// @brief Get an agent, without bounds checking
+    /// @param id The agent's id, which must be in the store
+    /// @return const agent_t* A pointer to the agent
+    const agent_t* operator[](Id id) const {
+      return &m_slots[m_pages[id >> m_pageBits]->slots[id & (m_pageSize - 1)]].value();
+    }
+
+    /// @brief Get the slot of an agent
+    /// @param id The agent's id, which must be in the store
+    /// @return Size The slot, lower than capacity(), which the agent keeps while in the store
+    /// @details Slots are recycled, so they can index side tables which follow the number of
+    /// agents rather than the largest id.
+    Size slot(Id id) const { return m_pages[id >> m_pageBits]->slots[id & (m_pageSize - 1)]; }
+
+    /// @brief Get the number of agents
+    /// @return std::size_t The number of agents in the store
+    std::size_t size() const { return m_size; }
+    /// @brief Check if the store is empty
+    /// @return bool True if the store is empty, false otherwise
+    bool empty() const { return m_size == 0; }
+    /// @brief Get the first free id after the ones in use
+    /// @return Id The largest id in the store plus one, or zero if the store is empty
+    Id nextId() const { return m_ids.empty() ? Id{0} : m_ids.back() + 1; }
+    /// @brief Get the number of slots, used or free
+    /// @return std::size_t The number of slots
+    std::size_t capacity() const { return m_slots.size(); }
+    /// @brief Get the number of id pages currently allocated
+    /// @return std::size_t The number of pages, each mapping 4096 consecutive ids
+    std::size_t nPages() const {
+      return static_cast<std::size_t>(
+          std::count_if(m_pages.cbegin(), m_pages.cend(), [](auto const& pPage) {
+            return static_cast<bool>(pPage);
+          }));
+    }
+    /// @brief Get the number of ids kept for the iteration, including erased ones
+    /// @return std::size_t The number of ids, at most twice the number of agents
+    std::size_t nIds() const { return m_ids.size(); }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, m_ids.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_ids.size()); }
+  };
+};  // namespace dsm
@@ -0,0 +1,74 @@
+/// @file utility/DijkstraWorkspace.hpp
+/// @brief This file contains the definition of the DijkstraWorkspace class.
+///
+/// @details The DijkstraWorkspace class holds the buffers used by the Dijkstra algorithm.
+///          Keeping a workspace alive between queries allows consecutive searches on the
+///          same graph to run without any memory allocation.
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "Typedef.hpp"
+
+namespace dsm {
+
+  /// @brief The DijkstraWorkspace class holds the search state of a Dijkstra algorithm.
+  /// @details The workspace contains the distance and predecessor arrays and the binary
+  ///          heap used as priority queue. The buffers only grow, so a workspace can be
+  ///          reused for any number of queries.
+  class DijkstraWorkspace {
+  private:
+    std::vector<double> m_distances;
+    std::vector<Id> m_previous;
+    std::vector<std::pair<double, Id>> m_heap;
+
+  public:
+    DijkstraWorkspace() = default;
+
+    /// @brief Reset the search state for a graph with the given number of nodes
+    /// @param nNodes The number of nodes of the graph
+    /// @details Every distance is set to std::numeric_limits<double>::max() and every
+    ///          predecessor to std::numeric_limits<Id>::max(). The heap is emptied.
+    void reset(std::size_t nNodes) {
+      m_distances.assign(nNodes, std::numeric_limits<double>::max());
+      m_previous.assign(nNodes, std::numeric_limits<Id>::max());
+      m_heap.clear();
+    }
+    /// @brief Push a node in the priority queue
+    /// @param nodeId The id of the node
+    /// @param distance The tentative distance of the node
+    void push(Id nodeId, double distance) {
+      m_heap.emplace_back(distance, nodeId);
+      std::push_heap(m_heap.begin(), m_heap.end(), std::greater<>{});
+    }
+    /// @brief Pop the node with the smallest tentative distance from the priority queue
+    /// @return A pair containing the distance and the id of the node
+    std::pair<double, Id> pop() {
+      std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<>{});
+      const auto top{m_heap.back()};
+      m_heap.pop_back();
+      return top;
+    }
+    /// @brief Check if the priority queue is empty
+    /// @return True if the priority queue is empty, false otherwise
+    bool empty() const { return m_heap.empty(); }
+
+    /// @brief Get the distances of the nodes from the source
+    /// @return A vector containing the distances, indexed by node id
+    std::vector<double>& distances() { return m_distances; }
+    /// @brief Get the distances of the nodes from the source
+    /// @return A vector containing the distances, indexed by node id
+    const std::vector<double>& distances() const { return m_distances; }
+    /// @brief Get the predecessors of the nodes in the shortest path tree
+    /// @return A vector containing the predecessors, indexed by node id
+    std::vector<Id>& previous() { return m_previous; }
+    /// @brief Get the predecessors of the nodes in the shortest path tree
+    /// @return A vector containing the predecessors, indexed by node id
+    const std::vector<Id>& previous() const { return m_previous; }
+  };
+};  // namespace dsm
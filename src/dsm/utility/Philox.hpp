@@ -0,0 +1,73 @@
+/// @file utility/Philox.hpp
+/// @brief This file contains the definition of the Philox class.
+///
+/// @details The Philox class is the Philox4x32-10 counter-based random number generator
+///          by Salmon et al. (2011). Each counter is mapped to 128 random bits by a keyed
+///          bijection, so any draw can be computed on its own, without a shared state.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace dsm {
+
+  /// @brief The Philox class maps a counter and a key to 128 random bits
+  /// @details The generator has no state besides its key: the same counter always gives
+  ///          the same bits, and different counters give independent ones.
+  class Philox {
+  public:
+    using counter_t = std::array<uint32_t, 4>;
+
+  private:
+    static constexpr uint32_t m_multiplier0{0xD2511F53};
+    static constexpr uint32_t m_multiplier1{0xCD9E8D57};
+    static constexpr uint32_t m_weyl0{0x9E3779B9};
+    static constexpr uint32_t m_weyl1{0xBB67AE85};
+    static constexpr int m_nRounds{10};
+
+    std::array<uint32_t, 2> m_key{0, 0};
+
+  public:
+    Philox() = default;
+    /// @brief Construct a new Philox object
+    /// @param seed The seed, used as key
+    explicit Philox(uint64_t seed) { this->seed(seed); }
+
+    /// @brief Set the key of the generator
+    /// @param seed The seed, used as key
+    void seed(uint64_t seed) {
+      m_key = {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+    }
+    /// @brief Set the key of the generator
+    /// @param key The key
+    void setKey(std::array<uint32_t, 2> key) { m_key = key; }
+
+    /// @brief Get the random bits of a counter
+    /// @param counter The counter
+    /// @return counter_t The 128 random bits
+    counter_t operator()(counter_t counter) const {
+      auto key{m_key};
+      for (int round{0}; round < m_nRounds; ++round) {
+        auto const product0{static_cast<uint64_t>(m_multiplier0) * counter[0]};
+        auto const product1{static_cast<uint64_t>(m_multiplier1) * counter[2]};
+        counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                   static_cast<uint32_t>(product1),
+                   static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                   static_cast<uint32_t>(product0)};
+        key[0] += m_weyl0;
+        key[1] += m_weyl1;
+      }
+      return counter;
+    }
+
+    /// @brief Convert 64 random bits in a number uniformly distributed in [0, 1)
+    /// @param high The 32 high bits
+    /// @param low The 32 low bits
+    /// @return double The number, with 53 random bits
+    static double toUniform(uint32_t high, uint32_t low) {
+      auto const bits{(static_cast<uint64_t>(high) << 32) | low};
+      return static_cast<double>(bits >> 11) * 0x1.0p-53;
+    }
+  };
+};  // namespace dsm
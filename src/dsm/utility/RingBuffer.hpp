@@ -0,0 +1,151 @@
+/// @file utility/RingBuffer.hpp
+/// @brief This file contains the definition of the RingBuffer class.
+///
+/// @details The RingBuffer class is a first-in first-out queue stored in a single
+///          contiguous buffer. Once the buffer has been reserved, pushing and popping
+///          elements never allocates.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace dsm {
+
+  /// @brief The RingBuffer class is a FIFO queue over a circular buffer
+  /// @tparam T The type of the elements
+  /// @details If an element is pushed in a full buffer, the buffer doubles its capacity.
+  template <typename T>
+  class RingBuffer {
+  private:
+    std::vector<T> m_data;
+    std::size_t m_head{0};
+    std::size_t m_size{0};
+
+    std::size_t m_wrap(std::size_t index) const {
+      return index < m_data.size() ? index : index - m_data.size();
+    }
+
+  public:
+    class const_iterator {
+    private:
+      const RingBuffer* m_pBuffer{nullptr};
+      std::size_t m_index{0};
+
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const T*;
+      using reference = const T&;
+
+      const_iterator() = default;
+      const_iterator(const RingBuffer* pBuffer, std::size_t index)
+          : m_pBuffer{pBuffer}, m_index{index} {}
+
+      reference operator*() const { return (*m_pBuffer)[m_index]; }
+      pointer operator->() const { return &(*m_pBuffer)[m_index]; }
+      const_iterator& operator++() {
+        ++m_index;
+        return *this;
+      }
+      const_iterator operator++(int) {
+        auto copy{*this};
+        ++m_index;
+        return copy;
+      }
+      bool operator==(const const_iterator& other) const {
+        return m_index == other.m_index;
+      }
+    };
+
+    RingBuffer() = default;
+    /// @brief Construct a new RingBuffer object
+    /// @param capacity The number of elements which can be stored without allocating
+    explicit RingBuffer(std::size_t capacity) : m_data(capacity) {}
+
+    /// @brief Make room for at least a number of elements, keeping the stored ones
+    /// @param capacity The number of elements
+    void reserve(std::size_t capacity) {
+      if (capacity <= m_data.size()) {
+        return;
+      }
+      std::vector<T> data(capacity);
+      for (std::size_t i{0}; i < m_size; ++i) {
+        data[i] = std::move((*this)[i]);
+      }
+      m_data = std::move(data);
+      m_head = 0;
+    }
+    /// @brief Add an element at the back of the queue
+    /// @param value The element
+    void push(T value) {
+      if (m_size == m_data.size()) {
+        reserve(std::max<std::size_t>(2 * m_data.size(), 1));
+      }
+      m_data[m_wrap(m_head + m_size)] = std::move(value);
+      ++m_size;
+    }
+    /// @brief Remove the element at the front of the queue
+    /// @details The queue must not be empty.
+    void pop() {
+      m_head = m_wrap(m_head + 1);
+      --m_size;
+    }
+    /// @brief Remove an element from the queue, keeping the order of the others
+    /// @param value The element
+    /// @return bool True if the element has been found and removed, false otherwise
+    /// @details The elements in front of the removed one are shifted back by one place,
+    /// which is cheap when the element is close to the front.
+    bool erase(const T& value) {
+      std::size_t position{0};
+      while (position < m_size && !((*this)[position] == value)) {
+        ++position;
+      }
+      if (position == m_size) {
+        return false;
+      }
+      for (; position > 0; --position) {
+        (*this)[position] = std::move((*this)[position - 1]);
+      }
+      this->pop();
+      return true;
+    }
+    /// @brief Remove all the elements, keeping the capacity
+    void clear() {
+      m_head = 0;
+      m_size = 0;
+    }
+
+    /// @brief Check if an element is in the queue
+    /// @param value The element
+    /// @return bool True if the element is in the queue, false otherwise
+    bool contains(const T& value) const {
+      return std::find(begin(), end(), value) != end();
+    }
+    /// @brief Get the i-th element from the front
+    T& operator[](std::size_t i) { return m_data[m_wrap(m_head + i)]; }
+    /// @brief Get the i-th element from the front
+    const T& operator[](std::size_t i) const { return m_data[m_wrap(m_head + i)]; }
+    /// @brief Get the element at the front of the queue
+    const T& front() const { return m_data[m_head]; }
+    /// @brief Get the element at the back of the queue
+    const T& back() const { return (*this)[m_size - 1]; }
+
+    /// @brief Get the number of elements
+    /// @return std::size_t The number of elements in the queue
+    std::size_t size() const { return m_size; }
+    /// @brief Check if the queue is empty
+    /// @return bool True if the queue is empty, false otherwise
+    bool empty() const { return m_size == 0; }
+    /// @brief Get the number of elements which can be stored without allocating
+    /// @return std::size_t The capacity of the buffer
+    std::size_t capacity() const { return m_data.size(); }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_size); }
+  };
+};  // namespace dsm
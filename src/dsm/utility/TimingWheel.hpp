@@ -0,0 +1,75 @@
+/// @file utility/TimingWheel.hpp
+/// @brief This file contains the definition of the TimingWheel class.
+///
+/// @details The TimingWheel class is a calendar queue of events identified by an id.
+///          Events are hashed into buckets by their due time, so scheduling an event and
+///          extracting the events due at a given time cost O(1) per event.
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "Typedef.hpp"
+
+namespace dsm {
+
+  /// @brief The TimingWheel class schedules events at discrete times.
+  /// @details The wheel has a power of two number of buckets. Events due farther than one
+  ///          revolution stay in their bucket until their round comes, so any due time can be
+  ///          scheduled. Times must be polled in increasing order, without skipping any.
+  class TimingWheel {
+  private:
+    std::vector<std::vector<std::pair<Time, Id>>> m_buckets;
+    Time m_mask;
+    std::size_t m_size{0};
+
+  public:
+    /// @brief Construct a new TimingWheel object
+    /// @param nBuckets The minimum number of buckets, rounded up to a power of two
+    explicit TimingWheel(std::size_t nBuckets = 1024)
+        : m_buckets(std::bit_ceil(std::max<std::size_t>(nBuckets, 1))),
+          m_mask{static_cast<Time>(m_buckets.size() - 1)} {}
+
+    /// @brief Schedule an event
+    /// @param id The id of the event
+    /// @param dueTime The time at which the event is due
+    void schedule(Id id, Time dueTime) {
+      m_buckets[dueTime & m_mask].emplace_back(dueTime, id);
+      ++m_size;
+    }
+    /// @brief Extract the events due at a given time
+    /// @param time The time
+    /// @param dueIds The vector to which the ids of the due events are appended
+    void pop(Time time, std::vector<Id>& dueIds) {
+      auto& bucket{m_buckets[time & m_mask]};
+      std::size_t nKept{0};
+      for (auto const& event : bucket) {
+        if (event.first == time) {
+          dueIds.push_back(event.second);
+        } else {
+          bucket[nKept++] = event;
+        }
+      }
+      m_size -= bucket.size() - nKept;
+      bucket.resize(nKept);
+    }
+    /// @brief Remove all the events
+    void clear() {
+      for (auto& bucket : m_buckets) {
+        bucket.clear();
+      }
+      m_size = 0;
+    }
+
+    /// @brief Get the number of scheduled events
+    /// @return std::size_t The number of scheduled events
+    std::size_t size() const { return m_size; }
+    /// @brief Check if there are no scheduled events
+    /// @return bool True if there are no scheduled events, false otherwise
+    bool empty() const { return m_size == 0; }
+  };
+};  // namespace dsm
@@ -0,0 +1,94 @@
+#include <cstddef>
+#include <vector>
+
+#include "../utility/ActiveSet.hpp"
+
+#include "doctest.h"
+
+using ActiveSet = dsm::ActiveSet;
+
+TEST_CASE("ActiveSet") {
+  SUBCASE("Insert and erase") {
+    GIVEN("A set of 10000 indices") {
+      ActiveSet set{10000};
+      CHECK(set.empty());
+      WHEN("We insert some indices, twice") {
+        for (auto const index : {9999, 0, 4096, 63, 64, 0}) {
+          set.insert(index);
+        }
+        THEN("Each index is stored once") {
+          CHECK_EQ(set.size(), 5);
+          CHECK(set.contains(0));
+          CHECK(set.contains(9999));
+          CHECK_FALSE(set.contains(1));
+          CHECK_FALSE(set.contains(20000));
+        }
+        THEN("Erasing an index removes it") {
+          set.erase(4096);
+          set.erase(4096);
+          CHECK_EQ(set.size(), 4);
+          CHECK_FALSE(set.contains(4096));
+        }
+        THEN("Clearing the set removes all the indices") {
+          set.clear();
+          CHECK(set.empty());
+          CHECK_FALSE(set.contains(0));
+        }
+      }
+    }
+  }
+  SUBCASE("next") {
+    GIVEN("A set with some indices") {
+      ActiveSet set{10000};
+      for (auto const index : {3, 4095, 9999}) {
+        set.insert(index);
+      }
+      THEN("The next element is found across empty words") {
+        CHECK_EQ(set.next(0).value_or(0), 3);
+        CHECK_EQ(set.next(3).value_or(0), 3);
+        CHECK_EQ(set.next(4).value_or(0), 4095);
+        CHECK_EQ(set.next(4096).value_or(0), 9999);
+        CHECK_FALSE(set.next(10000).has_value());
+      }
+    }
+  }
+  SUBCASE("retainIf") {
+    GIVEN("A set with some indices") {
+      ActiveSet set{10000};
+      for (auto const index : {5000, 3, 4095, 4096, 64}) {
+        set.insert(index);
+      }
+      WHEN("We visit the set, removing the even indices") {
+        std::vector<std::size_t> visited;
+        set.retainIf([&visited](std::size_t index) {
+          visited.push_back(index);
+          return index % 2 == 1;
+        });
+        THEN("The indices are visited in increasing order") {
+          CHECK_EQ(visited, (std::vector<std::size_t>{3, 64, 4095, 4096, 5000}));
+        }
+        THEN("Only the odd indices are kept") {
+          CHECK_EQ(set.size(), 2);
+          CHECK(set.contains(3));
+          CHECK(set.contains(4095));
+        }
+      }
+      WHEN("The callable inserts other indices") {
+        std::vector<std::size_t> visited;
+        set.retainIf([&set, &visited](std::size_t index) {
+          visited.push_back(index);
+          if (index == 3) {
+            set.insert(9000);
+            set.insert(5);
+            set.insert(1);
+          }
+          return true;
+        });
+        THEN("Only the indices after the current one are visited") {
+          CHECK_EQ(visited, (std::vector<std::size_t>{3, 5, 64, 4095, 4096, 5000, 9000}));
+          CHECK_EQ(set.size(), 8);
+        }
+      }
+    }
+  }
+}
@@ -52,4 +52,39 @@ TEST_CASE("Agent") {
       }
     }
   }
+  SUBCASE("Next street") {
+    GIVEN("An agent") {
+      Agent agent{1, 0};
+      CHECK_FALSE(agent.nextStreetId().has_value());
+      WHEN("The next street is set") {
+        agent.setNextStreetId(3);
+        THEN("It is stored in the agent") { CHECK_EQ(agent.nextStreetId().value_or(0), 3); }
+        THEN("Resetting the agent clears it") {
+          agent.reset();
+          CHECK_FALSE(agent.nextStreetId().has_value());
+        }
+      }
+    }
+  }
+  SUBCASE("Dense itinerary index") {
+    GIVEN("An agent with a trip of two itineraries") {
+      Agent agent{1, std::vector<dsm::Id>{7, 9}};
+      CHECK_FALSE(agent.denseItineraryIndex().has_value());
+      WHEN("The dense itinerary index is set") {
+        agent.setDenseItineraryIndex(2);
+        THEN("It is stored in the agent") {
+          CHECK_EQ(agent.denseItineraryIndex().value_or(0), 2);
+        }
+        THEN("Moving to the next itinerary clears it") {
+          agent.updateItinerary();
+          CHECK_EQ(agent.itineraryId(), 9);
+          CHECK_FALSE(agent.denseItineraryIndex().has_value());
+        }
+        THEN("Resetting the agent clears it") {
+          agent.reset();
+          CHECK_FALSE(agent.denseItineraryIndex().has_value());
+        }
+      }
+    }
+  }
 }
@@ -0,0 +1,140 @@
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "Agent.hpp"
+#include "../utility/AgentStore.hpp"
+
+#include "doctest.h"
+
+using Agent = dsm::Agent<uint16_t>;
+using AgentStore = dsm::AgentStore<Agent>;
+
+TEST_CASE("AgentStore") {
+  SUBCASE("Insertions") {
+    GIVEN("An empty store") {
+      AgentStore store;
+      CHECK(store.empty());
+      CHECK_EQ(store.nextId(), 0);
+      WHEN("We insert some agents") {
+        store.insert(Agent{0, 1});
+        store.insert(Agent{2, 3});
+        THEN("The agents are found by id") {
+          CHECK_EQ(store.size(), 2);
+          CHECK(store.contains(0));
+          CHECK_FALSE(store.contains(1));
+          CHECK(store.contains(2));
+          CHECK_EQ(store.at(0)->itineraryId(), 1);
+          CHECK_EQ(store[2]->itineraryId(), 3);
+          CHECK_EQ(store.nextId(), 3);
+        }
+        THEN("Inserting an existing id throws") {
+          CHECK_THROWS_AS(store.insert(Agent{2, 0}), std::invalid_argument);
+        }
+        THEN("Accessing a missing id throws") {
+          CHECK_THROWS_AS(store.at(1), std::out_of_range);
+        }
+      }
+    }
+  }
+  SUBCASE("Deletions") {
+    GIVEN("A store with three agents") {
+      AgentStore store;
+      store.insert(Agent{0, 0});
+      store.insert(Agent{1, 1});
+      store.insert(Agent{2, 2});
+      WHEN("We erase the last agent") {
+        CHECK_EQ(store.erase(2), 1);
+        THEN("The next id is updated") {
+          CHECK_EQ(store.size(), 2);
+          CHECK_EQ(store.nextId(), 2);
+          CHECK_EQ(store.erase(2), 0);
+        }
+      }
+      WHEN("We erase an agent and insert a new one") {
+        auto const* pAgent{store.at(2)};
+        store.erase(0);
+        store.insert(Agent{3, 3});
+        THEN("The free slot is recycled and the other agents do not move") {
+          CHECK_EQ(store.size(), 3);
+          CHECK_EQ(store.capacity(), 3);
+          CHECK_EQ(store.at(2), pAgent);
+          CHECK_EQ(store.at(3)->itineraryId(), 3);
+        }
+      }
+    }
+  }
+  SUBCASE("Iteration") {
+    GIVEN("A store with agents inserted out of order") {
+      AgentStore store;
+      store.insert(Agent{4, 0});
+      store.insert(Agent{1, 0});
+      store.insert(Agent{2, 0});
+      store.erase(2);
+      WHEN("We iterate over the store") {
+        std::vector<dsm::Id> ids;
+        for (auto const& [agentId, pAgent] : store) {
+          CHECK_EQ(agentId, pAgent->id());
+          ids.push_back(agentId);
+        }
+        THEN("The agents are visited in increasing id order") {
+          CHECK_EQ(ids, (std::vector<dsm::Id>{1, 4}));
+        }
+      }
+      WHEN("We erase an agent and insert it again") {
+        store.erase(1);
+        store.insert(Agent{2, 0});
+        store.insert(Agent{1, 0});
+        THEN("Every agent is visited once, in increasing id order") {
+          std::vector<dsm::Id> ids;
+          for (auto const& [agentId, pAgent] : store) {
+            ids.push_back(agentId);
+          }
+          CHECK_EQ(ids, (std::vector<dsm::Id>{1, 2, 4}));
+        }
+      }
+    }
+  }
+  SUBCASE("Churn") {
+    GIVEN("A store holding a fixed number of agents") {
+      AgentStore store;
+      for (dsm::Id agentId{0}; agentId < 100; ++agentId) {
+        store.insert(Agent{agentId, 0});
+      }
+      WHEN("Agents are replaced by new ones with increasing ids many times") {
+        dsm::Id oldest{0};
+        for (int i{0}; i < 200000; ++i) {
+          store.erase(oldest++);
+          store.insert(Agent{store.nextId(), 0});
+        }
+        THEN("The footprint follows the number of agents, not the largest id") {
+          CHECK_EQ(store.size(), 100);
+          CHECK_EQ(store.nextId(), 200100);
+          CHECK_EQ(store.capacity(), 100);
+          CHECK(store.nPages() <= 2);
+          CHECK(store.nIds() <= 200);
+          std::size_t nVisited{0};
+          for (auto const& [agentId, pAgent] : store) {
+            CHECK(agentId >= oldest);
+            ++nVisited;
+          }
+          CHECK_EQ(nVisited, 100);
+        }
+      }
+    }
+    GIVEN("An empty store") {
+      AgentStore store;
+      WHEN("We insert an agent with a very large id") {
+        store.insert(Agent{3000000000u, 0});
+        THEN("A single page is allocated") {
+          CHECK(store.contains(3000000000u));
+          CHECK_EQ(store.nPages(), 1);
+          CHECK_EQ(store.nextId(), 3000000001u);
+          store.erase(3000000000u);
+          CHECK_EQ(store.nPages(), 0);
+          CHECK(store.empty());
+        }
+      }
+    }
+  }
+}
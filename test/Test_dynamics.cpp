@@ -1,4 +1,5 @@
 #include <cstdint>
+#include <filesystem>
 
 #include "FirstOrderDynamics.hpp"
 #include "Graph.hpp"
@@ -19,6 +20,14 @@ using TrafficLight = dsm::TrafficLight;
 using Roundabout = dsm::Roundabout;
 using Measurement = dsm::Measurement<float>;
 
+struct CountingDataUpdate {
+  inline static int nCalls{0};
+  template <typename dynamics_t>
+  void operator()(const dynamics_t&) const {
+    ++nCalls;
+  }
+};
+
 TEST_CASE("Measurement") {
   SUBCASE("STL vector") {
     std::vector<float> data(100);
@@ -93,6 +102,24 @@ TEST_CASE("Dynamics") {
         }
       }
     }
+    GIVEN("A graph with an isolated node") {
+      SparseMatrix sm(3, 3);
+      sm.insert(0, 2, true);
+      sm.insert(2, 0, true);
+      Graph graph{sm};
+      CHECK_FALSE(graph.nodes()[1]);
+      WHEN("A dynamics object is created and evolved") {
+        Dynamics dynamics{graph, 69};
+        Itinerary itinerary{0, 2};
+        dynamics.addItinerary(itinerary);
+        dynamics.updatePaths();
+        dynamics.addAgent(0, 0, 0);
+        for (int i{0}; i < 10; ++i) {
+          dynamics.evolve(false);
+        }
+        THEN("The agent reaches its destination") { CHECK(dynamics.agents().empty()); }
+      }
+    }
   }
   SUBCASE("setDestinationNodes") {
     GIVEN("A dynamics object and a destination node") {
@@ -372,6 +399,11 @@ TEST_CASE("Dynamics") {
           CHECK(dynamics.itineraries().at(0)->path()(0, 1));
           CHECK(dynamics.itineraries().at(0)->path()(1, 2));
           CHECK_FALSE(dynamics.itineraries().at(0)->path()(0, 2));
+          auto const& nextHops{dynamics.itineraries().at(0)->nextHops()};
+          CHECK_EQ(nextHops.size(), 3);
+          CHECK(nextHops[dynamics.graph().streetIndex(1)]);
+          CHECK(nextHops[dynamics.graph().streetIndex(5)]);
+          CHECK_FALSE(nextHops[dynamics.graph().streetIndex(2)]);
           for (auto const& it : dynamics.itineraries()) {
             auto const& path = it.second->path();
             for (uint16_t i{0}; i < path.getRowDim(); ++i) {
@@ -384,6 +416,18 @@ TEST_CASE("Dynamics") {
           }
         }
       }
+      WHEN("We update the paths using a serial thread pool") {
+        CHECK_THROWS_AS(dynamics.setThreadPool(nullptr), std::invalid_argument);
+        dynamics.setThreadPool(std::make_shared<dsm::ThreadPool>(0));
+        dynamics.addItinerary(itinerary);
+        dynamics.updatePaths();
+        THEN("The path is the same") {
+          CHECK_EQ(dynamics.threadPool()->nWorkers(), 0);
+          CHECK(dynamics.itineraries().at(0)->path()(0, 1));
+          CHECK(dynamics.itineraries().at(0)->path()(1, 2));
+          CHECK_FALSE(dynamics.itineraries().at(0)->path()(0, 2));
+        }
+      }
     }
     GIVEN(
         "A dynamics objects, many streets and many itinearies with same "
@@ -445,6 +489,41 @@ TEST_CASE("Dynamics") {
           }
         }
       }
+      WHEN("We update the paths using a cache file") {
+        std::filesystem::remove("./data/temp.cache");
+        dynamics.setPathCacheFile("./data/temp.cache");
+        dynamics.updatePaths();
+        THEN("The cache file is written and the paths are loaded from it") {
+          CHECK(std::filesystem::exists("./data/temp.cache"));
+          Graph cachedGraph;
+          cachedGraph.addStreets(s1, s2, s3, s4);
+          cachedGraph.buildAdj();
+          Dynamics cachedDynamics{cachedGraph, 42};
+          cachedDynamics.addItinerary(itinerary);
+          cachedDynamics.setPathCacheFile("./data/temp.cache");
+          cachedDynamics.updatePaths();
+          auto const& cached{cachedDynamics.itineraries().at(0)};
+          CHECK_EQ(cached->path().size(), 4);
+          CHECK(cached->path()(0, 1));
+          CHECK(cached->path()(1, 2));
+          CHECK(cached->path()(0, 3));
+          CHECK(cached->path()(3, 2));
+          CHECK_EQ(cached->nextHops(), dynamics.itineraries().at(0)->nextHops());
+        }
+        THEN("A cache file written for other itineraries is not used") {
+          Graph otherGraph;
+          otherGraph.addStreets(s1, s2, s3, s4);
+          otherGraph.buildAdj();
+          Dynamics otherDynamics{otherGraph, 42};
+          otherDynamics.addItinerary(Itinerary{0, 3});
+          otherDynamics.setPathCacheFile("./data/temp.cache");
+          otherDynamics.updatePaths();
+          auto const& path{otherDynamics.itineraries().at(0)->path()};
+          CHECK_EQ(path.size(), 1);
+          CHECK(path(0, 3));
+        }
+        std::filesystem::remove("./data/temp.cache");
+      }
     }
   }
   SUBCASE("Evolve") {
@@ -481,6 +560,24 @@ TEST_CASE("Dynamics") {
         THEN("And again, reaching the destination") { CHECK(dynamics.agents().empty()); }
       }
     }
+    GIVEN("A dynamics object and an itinerary with a large id") {
+      Street s1{0, 1, 2., std::make_pair(0, 1)};
+      Street s2{1, 1, 5., std::make_pair(1, 2)};
+      Graph graph;
+      graph.addStreets(s1, s2);
+      graph.buildAdj();
+      Dynamics dynamics{graph, 69};
+      dsm::Id const itineraryId{std::numeric_limits<dsm::Id>::max() - 1};
+      dynamics.addItinerary(Itinerary{itineraryId, 2});
+      dynamics.updatePaths();
+      WHEN("We add an agent following it and evolve the dynamics") {
+        dynamics.addAgent(0, itineraryId, 0);
+        for (int i{0}; i < 4; ++i) {
+          dynamics.evolve(false);
+        }
+        THEN("The agent reaches the destination") { CHECK(dynamics.agents().empty()); }
+      }
+    }
     GIVEN("A dynamics object, an itinerary and an agent") {
       Street s1{0, 1, 13.8888888889, std::make_pair(0, 1)};
       Street s2{1, 1, 13.8888888889, std::make_pair(1, 0)};
@@ -572,6 +669,38 @@ TEST_CASE("Dynamics") {
       }
     }
   }
+  SUBCASE("Passage probability") {
+    GIVEN("A street with a transport capacity of 4 and a passage probability of 0.3") {
+      Street s1{0, 1, 2., std::make_pair(0, 1)};
+      s1.setTransportCapacity(4);
+      Street s2{1, 1, 5., std::make_pair(1, 2)};
+      WHEN("An agent reaches the end of the street with many different seeds") {
+        int nPassed{0};
+        int const nSeeds{500};
+        for (int seed{0}; seed < nSeeds; ++seed) {
+          Graph graph;
+          graph.addStreets(s1, s2);
+          graph.buildAdj();
+          Dynamics dynamics{graph, static_cast<unsigned>(seed)};
+          dynamics.setPassageProbability(0.3);
+          dynamics.addItinerary(Itinerary{0, 2});
+          dynamics.updatePaths();
+          dynamics.addAgent(0, 0, 0);
+          for (int i{0}; i < 3; ++i) {
+            dynamics.evolve(false);
+          }
+          if (dynamics.agents().at(0)->streetId().value_or(0) == 5) {
+            ++nPassed;
+          }
+        }
+        THEN("Every pass draws again, so the agent leaves with probability 1 - 0.7^4") {
+          auto const fraction{static_cast<double>(nPassed) / nSeeds};
+          CHECK(fraction > 0.7);
+          CHECK(fraction < 0.82);
+        }
+      }
+    }
+  }
   SUBCASE("TrafficLights") {
     GIVEN(
         "A dynamics object, a network with traffic lights, an itinerary and "
@@ -901,6 +1030,257 @@ TEST_CASE("Dynamics") {
       }
     }
   }
+  SUBCASE("Event-driven evolution") {
+    GIVEN("Two equal dynamics, one of which is event-driven") {
+      std::array<Graph, 2> graphs;
+      for (auto& graph : graphs) {
+        graph.importMatrix("./data/matrix.dat");
+        graph.buildAdj();
+      }
+      Dynamics dynamics{graphs[0], 69};
+      Dynamics eventDynamics{graphs[1], 69};
+      eventDynamics.setEventDriven(true);
+      CHECK(eventDynamics.isEventDriven());
+      std::array<uint32_t, 3> nodes{0, 1, 2};
+      for (auto* pDynamics : {&dynamics, &eventDynamics}) {
+        pDynamics->setDestinationNodes(nodes);
+        pDynamics->addAgentsUniformly(50);
+      }
+      WHEN("We evolve both dynamics") {
+        for (int i{0}; i < 200; ++i) {
+          dynamics.evolve(true);
+          eventDynamics.evolve(true);
+          CHECK_EQ(dynamics.nAgents(), eventDynamics.nAgents());
+          CHECK_EQ(dynamics.streetMeanDensity().mean,
+                   eventDynamics.streetMeanDensity().mean);
+        }
+        THEN("The evolution is the same") {
+          CHECK_EQ(dynamics.meanTravelTime().mean, eventDynamics.meanTravelTime().mean);
+          eventDynamics.setEventDriven(false);
+          for (auto const& [agentId, pAgent] : dynamics.agents()) {
+            auto const* pEventAgent{eventDynamics.agents().at(agentId)};
+            CHECK_EQ(pAgent->streetId(), pEventAgent->streetId());
+            CHECK_EQ(pAgent->delay(), pEventAgent->delay());
+            CHECK_EQ(pAgent->time(), pEventAgent->time());
+            CHECK_EQ(pAgent->distance(), doctest::Approx(pEventAgent->distance()));
+          }
+        }
+      }
+      WHEN("Arrived agents are removed and replaced by new ones") {
+        for (int i{0}; i < 200; ++i) {
+          for (auto* pDynamics : {&dynamics, &eventDynamics}) {
+            pDynamics->evolve(false);
+            if (pDynamics->nAgents() < 50) {
+              pDynamics->addAgentsUniformly(50 - pDynamics->nAgents());
+            }
+          }
+          CHECK_EQ(dynamics.nAgents(), eventDynamics.nAgents());
+          CHECK_EQ(dynamics.streetMeanDensity().mean,
+                   eventDynamics.streetMeanDensity().mean);
+        }
+        THEN("The evolution is the same, with the agent slots recycled") {
+          CHECK(dynamics.agents().nextId() > 50);
+          CHECK(eventDynamics.agents().capacity() <= 50);
+          eventDynamics.setEventDriven(false);
+          for (auto const& [agentId, pAgent] : dynamics.agents()) {
+            auto const* pEventAgent{eventDynamics.agents().at(agentId)};
+            CHECK_EQ(pAgent->streetId(), pEventAgent->streetId());
+            CHECK_EQ(pAgent->delay(), pEventAgent->delay());
+            CHECK_EQ(pAgent->time(), pEventAgent->time());
+          }
+        }
+      }
+    }
+  }
+  SUBCASE("Two-phase evolution") {
+    GIVEN("Two agents reaching a node which can host only one of them") {
+      Street s0{0, 10, 30., 15., std::make_pair(0, 1)};
+      Street s1{1, 10, 30., 15., std::make_pair(2, 1)};
+      Street s2{2, 10, 30., 15., std::make_pair(1, 3)};
+      Graph graph2;
+      graph2.addStreets(s0, s1, s2);
+      graph2.buildAdj();
+      graph2.nodeSet().at(1)->setCapacity(1);
+      Dynamics dynamics{graph2, 69};
+      dynamics.setTwoPhase(true);
+      CHECK(dynamics.isTwoPhase());
+      dynamics.addItinerary(Itinerary{0, 3});
+      dynamics.updatePaths();
+      // the agent on the second street is added first
+      dynamics.addAgent(0, 0, 2);
+      dynamics.addAgent(1, 0, 0);
+      WHEN("Both agents are at the end of their street") {
+        while (dynamics.agents().at(0)->delay() > 0 ||
+               !dynamics.agents().at(0)->streetId().has_value()) {
+          dynamics.evolve(false);
+        }
+        dynamics.evolve(false);
+        // the street ids are 1 (0 -> 1), 9 (2 -> 1) and 7 (1 -> 3)
+        THEN("The agent on the street with lower index enters the node") {
+          auto const& node{
+              dynamic_cast<const Intersection&>(*dynamics.graph().nodeSet().at(1))};
+          CHECK_EQ(node.agents().size(), 1);
+          CHECK_EQ(node.agents().front().second, 1);
+          CHECK_EQ(dynamics.graph().streetSet().at(9)->nExitingAgents(), 1);
+        }
+        THEN("The other agent leaves its street once the node is free") {
+          dynamics.evolve(false);
+          CHECK_EQ(dynamics.agents().at(1)->streetId().value_or(0), 7);
+          // the place freed in the node is taken only at the next step
+          CHECK_EQ(dynamics.graph().streetSet().at(9)->nExitingAgents(), 1);
+          dynamics.evolve(false);
+          CHECK_EQ(dynamics.graph().streetSet().at(9)->nExitingAgents(), 0);
+        }
+      }
+    }
+  }
+  SUBCASE("Partitioned two-phase evolution") {
+    GIVEN("Two equal dynamics split in partitions, run on different thread pools") {
+      std::array<Graph, 2> graphs;
+      for (auto& graph : graphs) {
+        graph.importMatrix("./data/matrix.dat");
+        graph.buildAdj();
+      }
+      Dynamics dynamics{graphs[0], 69};
+      Dynamics parallelDynamics{graphs[1], 69};
+      CHECK_EQ(dynamics.nPartitions(), 1);
+      CHECK_THROWS_AS(dynamics.setPartitions(0), std::invalid_argument);
+      dynamics.setThreadPool(std::make_shared<dsm::ThreadPool>(0));
+      parallelDynamics.setThreadPool(std::make_shared<dsm::ThreadPool>(3));
+      std::array<uint32_t, 3> nodes{0, 1, 2};
+      for (auto* pDynamics : {&dynamics, &parallelDynamics}) {
+        pDynamics->setTwoPhase(true);
+        pDynamics->setPartitions(4);
+        pDynamics->setDestinationNodes(nodes);
+        pDynamics->addAgentsUniformly(50);
+      }
+      CHECK_EQ(parallelDynamics.nPartitions(), 4);
+      WHEN("We evolve both dynamics") {
+        for (int i{0}; i < 200; ++i) {
+          dynamics.evolve(true);
+          parallelDynamics.evolve(true);
+          CHECK_EQ(dynamics.nAgents(), parallelDynamics.nAgents());
+          CHECK_EQ(dynamics.streetMeanDensity().mean,
+                   parallelDynamics.streetMeanDensity().mean);
+        }
+        THEN("The evolution does not depend on the number of threads") {
+          CHECK_EQ(dynamics.meanTravelTime().mean, parallelDynamics.meanTravelTime().mean);
+          for (auto const& [agentId, pAgent] : dynamics.agents()) {
+            auto const* pParallelAgent{parallelDynamics.agents().at(agentId)};
+            CHECK_EQ(pAgent->streetId(), pParallelAgent->streetId());
+            CHECK_EQ(pAgent->delay(), pParallelAgent->delay());
+            CHECK_EQ(pAgent->time(), pParallelAgent->time());
+          }
+        }
+      }
+    }
+  }
+  SUBCASE("Policies") {
+    GIVEN("A dynamics with strict route choice and a hook counting the data updates") {
+      using StrictDynamics = dsm::RoadDynamics<
+          dsm::Delay,
+          dsm::RoadPolicies<dsm::FirstOrderSpeed,
+                            dsm::TurnLaneSelection,
+                            dsm::StrictRouteChoice,
+                            CountingDataUpdate>>;
+      std::array<Graph, 2> graphs;
+      for (auto& graph : graphs) {
+        graph.importMatrix("./data/matrix.dat");
+        graph.buildAdj();
+      }
+      StrictDynamics strictDynamics{graphs[0], 69, 0.5};
+      Dynamics dynamics{graphs[1], 69, 0.5};
+      std::array<uint32_t, 3> nodes{0, 1, 2};
+      strictDynamics.setDestinationNodes(nodes);
+      dynamics.setDestinationNodes(nodes);
+      strictDynamics.setDataUpdatePeriod(10);
+      dynamics.setDataUpdatePeriod(10);
+      strictDynamics.addAgentsUniformly(50);
+      dynamics.addAgentsUniformly(50);
+      WHEN("We evolve it along a dynamics with zero error probability") {
+        for (int i{0}; i < 100; ++i) {
+          strictDynamics.evolve(true);
+          dynamics.evolve(true);
+        }
+        THEN("The evolution is the same and the hook is called at each data update") {
+          CHECK_EQ(CountingDataUpdate::nCalls, 10);
+          CHECK_EQ(strictDynamics.nAgents(), dynamics.nAgents());
+          CHECK_EQ(strictDynamics.meanTravelTime().mean, dynamics.meanTravelTime().mean);
+          CHECK_EQ(strictDynamics.streetMeanSpeed().mean, dynamics.streetMeanSpeed().mean);
+        }
+      }
+    }
+    GIVEN("Dynamics with intersection priorities chosen at compile time") {
+      using ForcedDynamics = dsm::RoadDynamics<
+          dsm::Delay,
+          dsm::RoadPolicies<dsm::FirstOrderSpeed,
+                            dsm::TurnLaneSelection,
+                            dsm::ShortestPathRouteChoice,
+                            dsm::NoDataUpdate,
+                            dsm::ForcedPriorities>>;
+      using FreeDynamics = dsm::RoadDynamics<
+          dsm::Delay,
+          dsm::RoadPolicies<dsm::FirstOrderSpeed,
+                            dsm::TurnLaneSelection,
+                            dsm::ShortestPathRouteChoice,
+                            dsm::NoDataUpdate,
+                            dsm::FreePriorities>>;
+      static_assert(ForcedDynamics::forcePriorities());
+      static_assert(!FreeDynamics::forcePriorities());
+      // agent 0 fills the street 0->3 just before agent 1 can take it, and agent 2,
+      // bound to node 2, is queued behind agent 1 in the intersection
+      auto buildGraph = []() {
+        Graph graph;
+        graph.addNode<Intersection>(0, std::make_pair(0., 0.));
+        graph.addNode<Intersection>(1, std::make_pair(-1., 0.));
+        graph.addNode<Intersection>(2, std::make_pair(1., 0.));
+        graph.addNode<Intersection>(3, std::make_pair(0., 1.));
+        graph.addNode<Intersection>(4, std::make_pair(0., -1.));
+        graph.addEdge<Street>(0, 4, 10., 10., std::make_pair(1, 0));
+        graph.addEdge<Street>(1, 4, 10., 10., std::make_pair(0, 2));
+        graph.addEdge<Street>(2, 1, 1000., 10., std::make_pair(0, 3));
+        graph.addEdge<Street>(3, 4, 10., 10., std::make_pair(4, 0));
+        graph.buildAdj();
+        graph.nodeSet().at(0)->setCapacity(3);
+        return graph;
+      };
+      auto addAgents = [](auto& dynamics) {
+        dynamics.addItinerary(Itinerary{0, 3});
+        dynamics.addItinerary(Itinerary{1, 2});
+        dynamics.updatePaths();
+        dynamics.addAgent(0, 0, 1);
+        dynamics.addAgent(1, 0, 4);
+        dynamics.addAgent(2, 1, 4);
+        for (int i{0}; i < 5; ++i) {
+          dynamics.evolve(false);
+        }
+      };
+      auto graph{buildGraph()};
+      auto forcedGraph{buildGraph()};
+      auto freeGraph{buildGraph()};
+      Dynamics dynamics{graph, 69};
+      ForcedDynamics forcedDynamics{forcedGraph, 69};
+      FreeDynamics freeDynamics{freeGraph, 69};
+      CHECK_FALSE(dynamics.forcePriorities());
+      dynamics.setForcePriorities(true);
+      WHEN("An agent in the intersection cannot enter its next street") {
+        addAgents(dynamics);
+        addAgents(forcedDynamics);
+        addAgents(freeDynamics);
+        THEN("Forced priorities hold the agents behind it, as the run-time flag does") {
+          CHECK_EQ(forcedDynamics.agents().at(0)->streetId().value(), 3);
+          CHECK_EQ(forcedDynamics.agents().at(1)->streetId().value(), 20);
+          CHECK_EQ(forcedDynamics.agents().at(2)->streetId().value(), 20);
+          CHECK_EQ(dynamics.agents().at(2)->streetId().value(), 20);
+          CHECK_EQ(forcedDynamics.nAgents(), dynamics.nAgents());
+        }
+        THEN("Free priorities let the agents behind it go") {
+          CHECK_EQ(freeDynamics.agents().at(1)->streetId().value(), 20);
+          CHECK_FALSE(freeDynamics.agents().contains(2));
+        }
+      }
+    }
+  }
   SUBCASE("streetMeanSpeed") {
     /// GIVEN: a dynamics object
     /// WHEN: we evolve the dynamics
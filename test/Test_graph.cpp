@@ -57,6 +57,26 @@ TEST_CASE("Graph") {
     CHECK_FALSE(graph.adjMatrix().contains(2, 1));
   }
 
+  SUBCASE("Constructor with an isolated node") {
+    // GIVEN: an adjacency matrix whose last node has no streets
+    // WHEN: we construct the graph
+    // THEN: the streets are found and the shortest path is computed
+    SparseMatrix sm(4, 4);
+    sm.insert(0, 1, true);
+    sm.insert(1, 0, true);
+    sm.insert(1, 2, true);
+    Graph graph{sm};
+    CHECK_EQ(graph.nNodes(), 3);
+    CHECK_EQ((*graph.street(0, 1))->id(), 1);
+    CHECK_EQ((*graph.street(1, 0))->id(), 4);
+    CHECK_EQ((*graph.street(1, 2))->id(), 6);
+    CHECK_EQ((*graph.oppositeStreet(1))->id(), 4);
+    CHECK_FALSE(graph.street(2, 3));
+    auto result = graph.shortestPath(0, 2);
+    CHECK(result.has_value());
+    CHECK(checkPath(result.value().path(), Path{0, 1, 2}));
+  }
+
   SUBCASE("Construction with addStreet") {
     Street s1(1, std::make_pair(0, 1));
     Street s2(2, std::make_pair(1, 2));
@@ -99,6 +119,113 @@ TEST_CASE("Graph") {
     CHECK_FALSE(graph.adjMatrix().contains(1, 3));
   }
 
+  SUBCASE("Adjacency lists") {
+    Street s1(1, std::make_pair(0, 1));
+    Street s2(2, std::make_pair(1, 2));
+    Street s3(3, std::make_pair(0, 2));
+    Street s4(4, std::make_pair(0, 3));
+    Street s5(5, std::make_pair(2, 3));
+    Graph graph;
+    graph.addStreets(s1, s2, s3, s4, s5);
+    graph.buildAdj();
+
+    auto const outNeighbours{graph.outNeighbours(0)};
+    auto const outStreets{graph.outStreets(0)};
+    CHECK_EQ(outNeighbours.size(), 3);
+    CHECK_EQ(outStreets.size(), 3);
+    for (size_t i{0}; i < outNeighbours.size(); ++i) {
+      CHECK_EQ(outNeighbours[i], i + 1);
+      CHECK_EQ(outStreets[i], i + 1);
+    }
+    auto const inNeighbours{graph.inNeighbours(3)};
+    auto const inStreets{graph.inStreets(3)};
+    CHECK_EQ(inNeighbours.size(), 2);
+    CHECK_EQ(inNeighbours[0], 0);
+    CHECK_EQ(inNeighbours[1], 2);
+    CHECK_EQ(inStreets[0], 3);
+    CHECK_EQ(inStreets[1], 11);
+    CHECK(graph.outNeighbours(3).empty());
+    CHECK(graph.inStreets(0).empty());
+    CHECK(graph.outStreets(4).empty());
+  }
+
+  SUBCASE("Dense storage") {
+    Street s1(1, std::make_pair(0, 1));
+    Street s2(2, std::make_pair(1, 2));
+    Street s3(3, std::make_pair(0, 2));
+    Street s4(4, std::make_pair(0, 3));
+    Street s5(5, std::make_pair(2, 3));
+    Graph graph;
+    graph.addStreets(s1, s2, s3, s4, s5);
+    graph.buildAdj();
+
+    CHECK_EQ(graph.nodes().size(), 4);
+    for (dsm::Id nodeId{0}; nodeId < 4; ++nodeId) {
+      CHECK_EQ(graph.nodes()[nodeId], graph.nodeSet().at(nodeId).get());
+    }
+    CHECK_EQ(graph.streets().size(), 5);
+    for (size_t i{0}; i < graph.streets().size(); ++i) {
+      auto const streetId{graph.streets()[i]->id()};
+      CHECK_EQ(graph.streets()[i], graph.streetSet().at(streetId).get());
+      CHECK_EQ(graph.streetIndex(streetId), i);
+    }
+    CHECK_EQ(graph.streets()[0]->id(), 1);
+    CHECK_EQ(graph.streets()[4]->id(), 11);
+    CHECK_THROWS_AS(graph.streetIndex(4), std::out_of_range);
+
+    graph.makeRoundabout(2);
+    CHECK(graph.nodes()[2]->isRoundabout());
+    graph.makeSpireStreet(11);
+    CHECK(graph.streets()[graph.streetIndex(11)]->isSpire());
+  }
+  SUBCASE("hash") {
+    Graph graph;
+    graph.addStreets(Street{1, 1, 2., std::make_pair(0, 1)},
+                     Street{2, 1, 3., std::make_pair(1, 2)});
+    graph.buildAdj();
+    Graph same;
+    same.addStreets(Street{1, 1, 2., std::make_pair(0, 1)},
+                    Street{2, 1, 3., std::make_pair(1, 2)});
+    same.buildAdj();
+    CHECK_EQ(graph.hash(), same.hash());
+    Graph longer;
+    longer.addStreets(Street{1, 1, 2., std::make_pair(0, 1)},
+                      Street{2, 1, 4., std::make_pair(1, 2)});
+    longer.buildAdj();
+    CHECK_NE(graph.hash(), longer.hash());
+    Graph reversed;
+    reversed.addStreets(Street{1, 1, 2., std::make_pair(1, 0)},
+                        Street{2, 1, 3., std::make_pair(2, 1)});
+    reversed.buildAdj();
+    CHECK_NE(graph.hash(), reversed.hash());
+  }
+  SUBCASE("More than 65535 nodes") {
+    // GIVEN: a graph whose squared number of nodes does not fit in an Id
+    // WHEN: we build the adjacency matrix
+    // THEN: the streets are numbered densely, following their node pairs
+    Graph graph{};
+    const dsm::Id n{70000};
+    for (dsm::Id nodeId{0}; nodeId < n; ++nodeId) {
+      graph.addNode<dsm::Intersection>(nodeId);
+    }
+    graph.addStreet(Street{10, 1, 1., std::make_pair(n - 1, 0)});
+    graph.addStreet(Street{11, 1, 1., std::make_pair(1, n - 1)});
+    graph.addStreet(Street{12, 1, 1., std::make_pair(1, 0)});
+    graph.addStreet(Street{13, 1, 1., std::make_pair(0, 1)});
+    graph.buildAdj();
+    CHECK_EQ(graph.adjMatrix().max_size(), static_cast<uint64_t>(n) * n);
+    CHECK(graph.adjMatrix().contains(n - 1, 0));
+    CHECK_EQ((*graph.street(0, 1))->id(), 0);
+    CHECK_EQ((*graph.street(1, 0))->id(), 1);
+    CHECK_EQ((*graph.street(1, n - 1))->id(), 2);
+    CHECK_EQ((*graph.street(n - 1, 0))->id(), 3);
+    CHECK_EQ((*graph.oppositeStreet(0))->id(), 1);
+    auto result = graph.shortestPath(0, n - 1);
+    CHECK(result.has_value());
+    CHECK(checkPath(result.value().path(), Path{0, 1, n - 1}));
+    CHECK_EQ(result.value().distance(), 2.);
+  }
+
   SUBCASE("importMatrix - dsm") {
     // This tests the importMatrix function over .dsm files
     // GIVEN: a graph
@@ -525,6 +652,59 @@ TEST_CASE("Dijkstra") {
     CHECK_FALSE(result.has_value());
   }
 
+  SUBCASE("Reused workspace") {
+    Street s1(0, 5, 3., std::make_pair(0, 1));
+    Street s2(1, 5, 1., std::make_pair(0, 2));
+    Street s3(2, 5, 7., std::make_pair(1, 2));
+    Street s4(3, 5, 2., std::make_pair(2, 3));
+    Street s5(4, 5, 1., std::make_pair(1, 4));
+    Street s6(5, 5, 5., std::make_pair(1, 3));
+    Graph graph{};
+    graph.addStreets(s1, s2, s3, s4, s5, s6);
+    graph.buildAdj();
+    dsm::DijkstraWorkspace workspace;
+    auto result = graph.shortestPath(0, 3, workspace);
+    Path correctPath{0, 2, 3};
+    CHECK(result.has_value());
+    CHECK(checkPath(result.value().path(), correctPath));
+    CHECK_EQ(result.value().distance(), 3.);
+    result = graph.shortestPath(0, 4, workspace);
+    correctPath = Path{0, 1, 4};
+    CHECK(result.has_value());
+    CHECK(checkPath(result.value().path(), correctPath));
+    CHECK_EQ(result.value().distance(), 4.);
+    result = graph.shortestPath(4, 0, workspace);
+    CHECK_FALSE(result.has_value());
+    result = graph.shortestPath(1, 3, workspace);
+    correctPath = Path{1, 3};
+    CHECK(result.has_value());
+    CHECK(checkPath(result.value().path(), correctPath));
+    CHECK_EQ(result.value().distance(), 5.);
+  }
+
+  SUBCASE("Distances from a destination") {
+    Street s1(0, 5, 3., std::make_pair(0, 1));
+    Street s2(1, 5, 1., std::make_pair(0, 2));
+    Street s3(2, 5, 7., std::make_pair(1, 2));
+    Street s4(3, 5, 2., std::make_pair(2, 3));
+    Street s5(4, 5, 1., std::make_pair(1, 4));
+    Street s6(5, 5, 5., std::make_pair(1, 3));
+    Graph graph{};
+    graph.addStreets(s1, s2, s3, s4, s5, s6);
+    graph.buildAdj();
+    dsm::DijkstraWorkspace workspace;
+    auto const& distances{graph.shortestDistances(3, workspace)};
+    CHECK_EQ(distances.size(), 5);
+    CHECK_EQ(distances[0], 3.);
+    CHECK_EQ(distances[1], 5.);
+    CHECK_EQ(distances[2], 2.);
+    CHECK_EQ(distances[3], 0.);
+    CHECK_EQ(distances[4], std::numeric_limits<double>::max());
+    for (dsm::Id nodeId{0}; nodeId < 3; ++nodeId) {
+      CHECK_EQ(distances[nodeId], graph.shortestPath(nodeId, 3).value().distance());
+    }
+  }
+
   SUBCASE("street and oppositeStreet") {
     GIVEN("A Graph object with two streets") {
       Graph graph{};
@@ -561,6 +741,23 @@ TEST_CASE("Dijkstra") {
           CHECK_THROWS_AS(graph.oppositeStreet(3), std::invalid_argument);
         }
       }
+      WHEN("We add a street after building the adjacency matrix") {
+        graph.addStreet(Street{10, 1, 2., std::make_pair(1, 2)});
+        THEN("The new street is found") {
+          auto result = graph.street(1, 2);
+          CHECK(result);
+          CHECK_EQ((*result)->id(), 10);
+          CHECK_FALSE(graph.oppositeStreet(10));
+        }
+        THEN("The index is rebuilt by buildAdj") {
+          graph.buildAdj();
+          auto result = graph.street(1, 2);
+          CHECK(result);
+          CHECK_EQ((*result)->id(), 5);
+          CHECK_EQ((*graph.street(1, 0))->id(), 3);
+          CHECK_EQ((*graph.oppositeStreet(1))->id(), 3);
+        }
+      }
     }
   }
 
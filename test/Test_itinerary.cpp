@@ -1,4 +1,5 @@
 #include <cstdint>
+#include <vector>
 
 #include "Itinerary.hpp"
 
@@ -20,4 +21,23 @@ TEST_CASE("Itinerary") {
       }
     }
   }
+  SUBCASE("Routing table") {
+    GIVEN("An itinerary") {
+      Itinerary itinerary{0, 2};
+      CHECK(itinerary.nextHops().empty());
+      WHEN("We set the routing table") {
+        itinerary.setNextHops(std::vector<bool>{true, false, true});
+        THEN("The routing table is set correctly") {
+          CHECK_EQ(itinerary.nextHops().size(), 3);
+          CHECK(itinerary.nextHops()[0]);
+          CHECK_FALSE(itinerary.nextHops()[1]);
+          CHECK(itinerary.nextHops()[2]);
+        }
+        THEN("Setting a new path clears the routing table") {
+          itinerary.setPath(dsm::SparseMatrix<bool>{3, 3});
+          CHECK(itinerary.nextHops().empty());
+        }
+      }
+    }
+  }
 }
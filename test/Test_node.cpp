@@ -1,4 +1,6 @@
 #include <cstdint>
+#include <stdexcept>
+#include <vector>
 
 #include "Node.hpp"
 #include "Intersection.hpp"
@@ -62,6 +64,33 @@ TEST_CASE("Intersection") {
       }
     }
   }
+  SUBCASE("Agents") {
+    GIVEN("An intersection with capacity four") {
+      Intersection intersection{0};
+      intersection.setCapacity(4);
+      WHEN("Agents are added with different angles") {
+        intersection.addAgent(0.5, 1);
+        intersection.addAgent(-0.5, 2);
+        intersection.addAgent(0.5, 3);
+        intersection.addAgent(0., 4);
+        THEN("They are sorted by angle, keeping the arrival order for equal angles") {
+          std::vector<dsm::Id> ids;
+          for (auto const& [angle, agentId] : intersection.agents()) {
+            ids.push_back(agentId);
+          }
+          CHECK_EQ(ids, (std::vector<dsm::Id>{2, 4, 1, 3}));
+          CHECK(intersection.isFull());
+          CHECK_THROWS_AS(intersection.addAgent(0., 5), std::runtime_error);
+        }
+        THEN("Removing an agent keeps the order of the others") {
+          intersection.removeAgent(4);
+          CHECK_EQ(intersection.agents().size(), 3);
+          CHECK_EQ(intersection.agents()[1].second, 1);
+          CHECK_FALSE(intersection.isFull());
+        }
+      }
+    }
+  }
 }
 
 TEST_CASE("TrafficLight") {
@@ -135,6 +164,28 @@ TEST_CASE("TrafficLight") {
       }
     }
   }
+  SUBCASE("Ticks to green") {
+    GIVEN("A traffic light whose left turn is green only once per cycle") {
+      TrafficLight tl{0, 4};
+      tl.setCycle(0, dsm::Direction::LEFT, {1, 2});
+      tl.setCycle(0, dsm::Direction::STRAIGHT, {0, 1});
+      THEN("The ticks before the next green are computed from the counter") {
+        CHECK_EQ(tl.ticksToGreen(0, dsm::Direction::RIGHT).value_or(99), 0);
+        CHECK_EQ(tl.ticksToGreen(0, dsm::Direction::LEFT).value_or(99), 2);
+        CHECK_EQ(tl.ticksToGreen(0, dsm::Direction::UTURN).value_or(99), 2);
+        ++tl;
+        ++tl;
+        ++tl;
+        CHECK_EQ(tl.ticksToGreen(0, dsm::Direction::LEFT).value_or(99), 3);
+      }
+      THEN("A light which is never green has no next green") {
+        CHECK_FALSE(tl.ticksToGreen(0, dsm::Direction::STRAIGHT).has_value());
+      }
+      THEN("An invalid street throws an exception") {
+        CHECK_THROWS_AS(tl.ticksToGreen(1, dsm::Direction::LEFT), std::invalid_argument);
+      }
+    }
+  }
   // SUBCASE("Phase") {
   //   /// This tests the phase.
   //   /// GIVEN: A TrafficLight
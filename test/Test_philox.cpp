@@ -0,0 +1,51 @@
+#include <array>
+#include <cstdint>
+
+#include "../utility/Philox.hpp"
+
+#include "doctest.h"
+
+using Philox = dsm::Philox;
+
+TEST_CASE("Philox") {
+  SUBCASE("Known answers") {
+    GIVEN("The reference vectors of Philox4x32-10") {
+      Philox philox;
+      THEN("A zero counter with a zero key gives the reference bits") {
+        CHECK_EQ(philox({0, 0, 0, 0}),
+                 (Philox::counter_t{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+      }
+      THEN("A full counter with a full key gives the reference bits") {
+        philox.setKey({0xffffffff, 0xffffffff});
+        CHECK_EQ(philox({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}),
+                 (Philox::counter_t{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+      }
+      THEN("The digits of pi give the reference bits") {
+        philox.setKey({0xa4093822, 0x299f31d0});
+        CHECK_EQ(philox({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}),
+                 (Philox::counter_t{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+      }
+    }
+  }
+  SUBCASE("Seed") {
+    GIVEN("Two generators with the same seed") {
+      Philox philox{69};
+      Philox other;
+      other.seed(69);
+      THEN("They give the same bits, whatever the order of the draws") {
+        auto const first{philox({1, 2, 3, 4})};
+        auto const second{philox({5, 6, 7, 8})};
+        CHECK_EQ(other({5, 6, 7, 8}), second);
+        CHECK_EQ(other({1, 2, 3, 4}), first);
+        CHECK_NE(first, second);
+      }
+    }
+  }
+  SUBCASE("Uniform") {
+    THEN("The bits are mapped in [0, 1)") {
+      CHECK_EQ(Philox::toUniform(0, 0), 0.);
+      CHECK_EQ(Philox::toUniform(0x80000000, 0), 0.5);
+      CHECK(Philox::toUniform(0xffffffff, 0xffffffff) < 1.);
+    }
+  }
+}
@@ -0,0 +1,77 @@
+#include <vector>
+
+#include "../utility/RingBuffer.hpp"
+#include "../utility/Typedef.hpp"
+
+#include "doctest.h"
+
+using RingBuffer = dsm::RingBuffer<dsm::Id>;
+
+TEST_CASE("RingBuffer") {
+  SUBCASE("Push and pop") {
+    GIVEN("A ring buffer with capacity three") {
+      RingBuffer buffer{3};
+      CHECK(buffer.empty());
+      CHECK_EQ(buffer.capacity(), 3);
+      WHEN("Elements are pushed and popped across the end of the buffer") {
+        buffer.push(1);
+        buffer.push(2);
+        buffer.pop();
+        buffer.push(3);
+        buffer.push(4);
+        THEN("The elements are kept in FIFO order without allocating") {
+          CHECK_EQ(buffer.capacity(), 3);
+          CHECK_EQ(buffer.size(), 3);
+          CHECK_EQ(buffer.front(), 2);
+          CHECK_EQ(buffer.back(), 4);
+          CHECK_EQ(std::vector<dsm::Id>(buffer.begin(), buffer.end()),
+                   (std::vector<dsm::Id>{2, 3, 4}));
+        }
+        THEN("Pushing in a full buffer grows it, keeping the order") {
+          buffer.push(5);
+          CHECK_EQ(buffer.capacity(), 6);
+          CHECK_EQ(std::vector<dsm::Id>(buffer.begin(), buffer.end()),
+                   (std::vector<dsm::Id>{2, 3, 4, 5}));
+        }
+      }
+    }
+    GIVEN("A ring buffer without capacity") {
+      RingBuffer buffer;
+      WHEN("An element is pushed") {
+        buffer.push(7);
+        THEN("The buffer allocates room for it") {
+          CHECK_EQ(buffer.capacity(), 1);
+          CHECK_EQ(buffer.front(), 7);
+        }
+      }
+    }
+  }
+  SUBCASE("Erase") {
+    GIVEN("A ring buffer which wraps around") {
+      RingBuffer buffer{4};
+      for (dsm::Id id{0}; id < 4; ++id) {
+        buffer.push(id);
+      }
+      buffer.pop();
+      buffer.pop();
+      buffer.push(4);
+      buffer.push(5);
+      WHEN("An element in the middle is erased") {
+        CHECK(buffer.erase(4));
+        THEN("The order of the other elements is kept") {
+          CHECK_EQ(buffer.size(), 3);
+          CHECK_EQ(std::vector<dsm::Id>(buffer.begin(), buffer.end()),
+                   (std::vector<dsm::Id>{2, 3, 5}));
+          CHECK_FALSE(buffer.contains(4));
+          CHECK(buffer.contains(5));
+        }
+      }
+      WHEN("A missing element is erased") {
+        THEN("Nothing happens") {
+          CHECK_FALSE(buffer.erase(42));
+          CHECK_EQ(buffer.size(), 4);
+        }
+      }
+    }
+  }
+}
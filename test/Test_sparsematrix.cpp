@@ -295,6 +295,21 @@ TEST_CASE("Boolean Matrix") {
     SparseMatrix<bool> m(3, 5);
     CHECK(m.max_size() == 15);
   }
+  SUBCASE("Linear index beyond 32 bits") {
+    /*This test tests if the linear index can address matrices with more than
+    2^32 elements
+    GIVEN: a matrix with 100000 rows and columns
+    WHEN: an element is inserted in the last row
+    THEN: the element is found both by row and column and by linear index
+    */
+    SparseMatrix<bool> m(100000, 100000);
+    CHECK_EQ(m.max_size(), 10000000000);
+    m.insert(99999, 99998, true);
+    CHECK(m.contains(99999, 99998));
+    CHECK(m.contains(static_cast<uint64_t>(99999) * 100000 + 99998));
+    CHECK_FALSE(m.contains(99998, 99999));
+    CHECK_EQ(m.getRow(99999).size(), 1);
+  }
   SUBCASE("Get size") {
     /*This test tests if the size function works correctly
     The size function should return the number of non-zero elements in the
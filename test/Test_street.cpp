@@ -127,6 +127,12 @@ TEST_CASE("Street") {
     CHECK_EQ(street.queue(0).size(), street.capacity());
     CHECK_EQ(doctest::Approx(street.density()), 1.14286);
     CHECK(street.isFull());
+    // the queues are preallocated to the street's capacity
+    CHECK_EQ(street.queue(0).capacity(), street.capacity());
+    CHECK_EQ(street.waitingAgents().capacity(), street.capacity());
+    street.setCapacity(8);
+    CHECK_EQ(street.queue(0).capacity(), 8);
+    CHECK_EQ(street.queue(0).front(), 1);
   }
 
   SUBCASE("Dequeue") {
@@ -164,6 +170,41 @@ TEST_CASE("Street") {
     // check that the result of dequeue is std::nullopt
     CHECK_FALSE(street.dequeue(0).has_value());
   }
+  SUBCASE("Aggregates") {
+    GIVEN("A street with two lanes") {
+      Street street{1, 4, 10., 20., std::make_pair(0, 1), 2};
+      WHEN("Agents are added with their speeds and some of them are enqueued") {
+        street.addAgent(1, 10.);
+        street.addAgent(2, 5.);
+        street.addAgent(3, 3.);
+        street.enqueue(1, 0);
+        street.enqueue(2, 1);
+        THEN("The counters and the speed sum are kept up to date") {
+          CHECK_EQ(street.nAgents(), 3);
+          CHECK_EQ(street.nExitingAgents(), 2);
+          CHECK_EQ(street.speedSum(), 18.);
+          CHECK_EQ(street.meanSpeed(), 6.);
+          CHECK_EQ(street.density(true), 0.75);
+        }
+        THEN("Stopped and dequeued agents leave the aggregates") {
+          street.stopAgent(10.);
+          street.dequeue(0);
+          CHECK_EQ(street.nAgents(), 2);
+          CHECK_EQ(street.nExitingAgents(), 1);
+          CHECK_EQ(street.meanSpeed(), 4.);
+        }
+        THEN("Replacing a queue updates the number of exiting agents") {
+          dsm::RingBuffer<dsm::Id> queue{4};
+          queue.push(4);
+          queue.push(5);
+          street.setQueue(queue, 0);
+          CHECK_EQ(street.nExitingAgents(), 3);
+          CHECK_EQ(street.nAgents(), 4);
+          CHECK(street.isFull());
+        }
+      }
+    }
+  }
   SUBCASE("Angle") {
     /// This tests the angle method
     /// GIVEN: A street
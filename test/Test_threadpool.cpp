@@ -0,0 +1,89 @@
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+#include "doctest.h"
+
+using ThreadPool = dsm::ThreadPool;
+
+TEST_CASE("ThreadPool") {
+  SUBCASE("Constructor") {
+    GIVEN("A number of workers") {
+      WHEN("The pool is constructed") {
+        ThreadPool pool{3};
+        THEN("The number of workers is correct") {
+          CHECK_EQ(pool.nWorkers(), 3);
+          CHECK_EQ(pool.concurrency(), 4);
+        }
+      }
+    }
+  }
+  SUBCASE("parallelFor") {
+    GIVEN("A pool with some workers") {
+      ThreadPool pool{4};
+      WHEN("We run a loop with uneven iteration costs") {
+        std::vector<std::size_t> results(1000, 0);
+        pool.parallelFor(results.size(), [&results](std::size_t i) {
+          std::size_t sum{0};
+          for (std::size_t j{0}; j < (i % 10) * 1000; ++j) {
+            sum += j % 7;
+          }
+          results[i] = i + sum - sum;
+        });
+        THEN("Every index is processed exactly once") {
+          for (std::size_t i{0}; i < results.size(); ++i) {
+            CHECK_EQ(results[i], i);
+          }
+        }
+      }
+      WHEN("We run several loops on the same pool") {
+        std::atomic<std::size_t> counter{0};
+        for (int k{0}; k < 50; ++k) {
+          pool.parallelFor(10, [&counter](std::size_t) { ++counter; });
+        }
+        THEN("All the tasks are run") { CHECK_EQ(counter, 500); }
+      }
+      WHEN("A task throws an exception") {
+        std::atomic<std::size_t> counter{0};
+        THEN("The exception is propagated after all the other tasks are run") {
+          CHECK_THROWS_AS(pool.parallelFor(100,
+                                           [&counter](std::size_t i) {
+                                             ++counter;
+                                             if (i == 42) {
+                                               throw std::runtime_error("error");
+                                             }
+                                           }),
+                          std::runtime_error);
+          CHECK_EQ(counter, 100);
+          // the pool can still be used
+          pool.parallelFor(10, [&counter](std::size_t) { ++counter; });
+          CHECK_EQ(counter, 110);
+        }
+      }
+      WHEN("A task runs a loop on the same pool") {
+        std::atomic<std::size_t> counter{0};
+        pool.parallelFor(20, [&pool, &counter](std::size_t) {
+          pool.parallelFor(10, [&counter](std::size_t) { ++counter; });
+        });
+        THEN("The nested loop is run inline without deadlocking") {
+          CHECK_EQ(counter, 200);
+          pool.parallelFor(10, [&counter](std::size_t) { ++counter; });
+          CHECK_EQ(counter, 210);
+        }
+      }
+    }
+    GIVEN("A pool without workers") {
+      ThreadPool pool{0};
+      WHEN("We run a loop") {
+        std::vector<int> results(10, 0);
+        pool.parallelFor(results.size(), [&results](std::size_t i) { results[i] = 1; });
+        THEN("The loop is run by the caller") {
+          CHECK_EQ(std::accumulate(results.begin(), results.end(), 0), 10);
+        }
+      }
+    }
+  }
+}
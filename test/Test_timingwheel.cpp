@@ -0,0 +1,38 @@
+#include <vector>
+
+#include "../utility/TimingWheel.hpp"
+
+#include "doctest.h"
+
+using TimingWheel = dsm::TimingWheel;
+
+TEST_CASE("TimingWheel") {
+  SUBCASE("Schedule and pop") {
+    GIVEN("A timing wheel with four buckets") {
+      TimingWheel wheel{3};
+      CHECK(wheel.empty());
+      WHEN("We schedule events within and beyond one revolution") {
+        wheel.schedule(0, 1);
+        wheel.schedule(1, 5);
+        wheel.schedule(2, 1);
+        CHECK_EQ(wheel.size(), 3);
+        THEN("Each event is popped only when it comes due") {
+          std::vector<dsm::Id> dueIds;
+          wheel.pop(0, dueIds);
+          CHECK(dueIds.empty());
+          wheel.pop(1, dueIds);
+          CHECK_EQ(dueIds, (std::vector<dsm::Id>{0, 2}));
+          CHECK_EQ(wheel.size(), 1);
+          dueIds.clear();
+          for (dsm::Time time{2}; time < 5; ++time) {
+            wheel.pop(time, dueIds);
+          }
+          CHECK(dueIds.empty());
+          wheel.pop(5, dueIds);
+          CHECK_EQ(dueIds, (std::vector<dsm::Id>{1}));
+          CHECK(wheel.empty());
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,43 @@
+#include <cmath>
+#include <cstdint>
+
+#include "../utility/Philox.hpp"
+#include "../utility/Ziggurat.hpp"
+
+#include "doctest.h"
+
+using Philox = dsm::Philox;
+using Ziggurat = dsm::Ziggurat;
+
+TEST_CASE("Ziggurat") {
+  SUBCASE("Normal") {
+    GIVEN("Random bits from a counter-based generator") {
+      Philox philox{69};
+      WHEN("Many numbers are drawn") {
+        uint32_t const nDraws{200000};
+        double sum{0.}, sumSquares{0.};
+        uint32_t nOneSigma{0}, nAttempts{0};
+        for (uint32_t i{0}; i < nDraws; ++i) {
+          auto const x{Ziggurat::normal([&](uint32_t attempt) {
+            ++nAttempts;
+            return philox({i, attempt, 0, 0});
+          })};
+          sum += x;
+          sumSquares += x * x;
+          if (std::abs(x) < 1.) {
+            ++nOneSigma;
+          }
+        }
+        THEN("They follow a standard normal distribution") {
+          auto const mean{sum / nDraws};
+          CHECK(std::abs(mean) < 0.01);
+          CHECK(std::abs(sumSquares / nDraws - mean * mean - 1.) < 0.01);
+          CHECK(std::abs(static_cast<double>(nOneSigma) / nDraws - 0.6827) < 0.005);
+        }
+        THEN("Almost all the numbers need a single attempt") {
+          CHECK(nAttempts < nDraws * 1.02);
+        }
+      }
+    }
+  }
+}